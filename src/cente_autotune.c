@@ -12,40 +12,15 @@ float cente_autotune(const Board *b, int self_id, const InfluenceMap *inf,
                      cente_size_params *out) {
   *out = *base;
   int w = b->width, h = b->height;
-  int n = w * h;
   // Density of occupation
-  int occ = 0;
-  for (int i = 0; i < n; i++)
-    if (b->cells[i] <= 0)
-      occ++;
-  float density = (float)occ / (float)n; // [0,1]
+  float density = (float)b->stats.occupied / (float)(w * h); // [0,1]
 
   // Mobility
-  int mob_count = 0;
-  static const int dx[8] = {0, 1, 1, 1, 0, -1, -1, -1};
-  static const int dy[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
-  int x = b->head_x[self_id], y = b->head_y[self_id];
-  for (int d = 0; d < 8; d++) {
-    int nx = x + dx[d], ny = y + dy[d];
-    if (nx >= 0 && nx < w && ny >= 0 && ny < h) {
-      int c = b->cells[ny * w + nx];
-      int occu = c <= 0;
-      for (int j = 0; j < b->num_players && !occu; j++) {
-        if (j == self_id)
-          continue;
-        if (!b->blocked[j] && b->head_x[j] == (unsigned short)nx &&
-            b->head_y[j] == (unsigned short)ny)
-          occu = 1;
-      }
-      if (!occu)
-        mob_count++;
-    }
-  }
-  float mobility = (float)mob_count / 8.0f;
+  int i0 = b->head_y[self_id] * w + b->head_x[self_id];
+  float mobility = mobility_score(b, self_id);
 
   // Tempo proxy near our head
-  int i0 = y * w + x;
-  float tempo = 0.5f * inf->t[i0] + 0.5f * (1.0f - inf->grad[i0]);
+  float tempo = 0.5f * influence_t(inf, i0) + 0.5f * (1.0f - influence_grad(inf, i0));
   tempo = clamp01(tempo);
 
   // Adjust sigma: sparser -> higher sigma; dense -> lower sigma
@@ -72,8 +47,8 @@ float cente_autotune(const Board *b, int self_id, const InfluenceMap *inf,
       (phase == PHASE_OPENING ? 1.2f : (phase == PHASE_MIDGAME ? 1.0f : 0.8f));
   kf *= (0.9f + 0.3f * mobility);
   int kadj = (int)lroundf((float)k * kf);
-  if (kadj < 6)
-    kadj = 6;
+  if (kadj < 2)
+    kadj = 2;
   if (kadj > CENTE_MAX_CHILDREN)
     kadj = CENTE_MAX_CHILDREN;
   out->mcts.k_base = kadj;
@@ -0,0 +1,237 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+// Kernel micro-benchmarks: times the generic and the board-size specialised
+// variant of every kernel in CenteKernels that has one on the same mid-game position and
+// checks that both produce the same output, and that board_undo_move takes
+// back board_apply_move exactly.
+#include "include/cente_board.h"
+#include "include/cente_eval.h"
+#include "include/cente_influence.h"
+#include "include/cente_kernels.h"
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_SIGMA 1.5f
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static uint64_t splitmix(uint64_t *s) {
+  uint64_t z = (*s += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// Random values with about a third of the cells taken and three heads
+static Board *bench_board(int w, int h, uint64_t seed) {
+  size_t n = (size_t)w * (size_t)h;
+  int *cells = (int *)malloc(n * sizeof(int));
+  if (!cells)
+    return NULL;
+  for (size_t i = 0; i < n; i++)
+    cells[i] = splitmix(&seed) % 3 == 0 ? -(int)(splitmix(&seed) % 3)
+                                         : 1 + (int)(splitmix(&seed) % 9);
+  unsigned short hx[CENTE_MAX_PLAYERS] = {0}, hy[CENTE_MAX_PLAYERS] = {0};
+  unsigned char blocked[CENTE_MAX_PLAYERS] = {0};
+  unsigned int score[CENTE_MAX_PLAYERS] = {0};
+  for (int p = 0; p < 3; p++) {
+    hx[p] = (unsigned short)(splitmix(&seed) % (uint64_t)w);
+    hy[p] = (unsigned short)(splitmix(&seed) % (uint64_t)h);
+    cells[hy[p] * w + hx[p]] = -p;
+  }
+  Board *b = board_create_from_shared(w, h, 3, hx, hy, blocked, score, cells,
+                                      0);
+  free(cells);
+  return b;
+}
+
+typedef struct {
+  const char *name;
+  double generic_ns, fixed_ns;
+  int same;
+} BenchResult;
+
+static void report(int w, int h, const BenchResult *r) {
+  printf("%2dx%-2d  %-12s %10.1f %10.1f   x%.2f  %s\n", w, h, r->name,
+         r->generic_ns, r->fixed_ns,
+         r->fixed_ns > 0.0 ? r->generic_ns / r->fixed_ns : 0.0,
+         r->same ? "ok" : "MISMATCH");
+}
+
+static double time_stats(const CenteKernels *k, Board *b, int reps) {
+  double t0 = now_ns();
+  for (int it = 0; it < reps; it++)
+    k->count_stats(b);
+  return (now_ns() - t0) / reps;
+}
+
+static void bench_stats(const CenteKernels *fixed, Board *b, int reps,
+                        BenchResult *r) {
+  size_t n = (size_t)b->width * (size_t)b->height;
+  unsigned char *ref = (unsigned char *)malloc(n);
+  r->name = "count_stats";
+  r->generic_ns = time_stats(kernels_generic(), b, reps);
+  int occupied = b->stats.occupied;
+  long long value = b->stats.free_value;
+  if (ref)
+    memcpy(ref, b->stats.free_nbr, n);
+  r->fixed_ns = time_stats(fixed, b, reps);
+  r->same = ref && occupied == b->stats.occupied &&
+            value == b->stats.free_value &&
+            memcmp(ref, b->stats.free_nbr, n) == 0;
+  free(ref);
+}
+
+static void bench_prior(const CenteKernels *fixed, const Board *b,
+                        const InfluenceMap *inf, int reps, BenchResult *r) {
+  CenteMove moves[8];
+  int n = board_legal_moves(b, 0, moves, 8);
+  float out[2][8] = {{0}};
+  const CenteKernels *k[2] = {kernels_generic(), fixed};
+  double t[2];
+  r->name = "prior_batch";
+  for (int v = 0; v < 2; v++) {
+    double t0 = now_ns();
+    for (int it = 0; it < reps; it++)
+      k[v]->prior_batch(b, 0, inf, moves, n, out[v]);
+    t[v] = (now_ns() - t0) / reps;
+  }
+  r->generic_ns = t[0];
+  r->fixed_ns = t[1];
+  r->same = memcmp(out[0], out[1], sizeof(out[0])) == 0;
+}
+
+static int same_board(const Board *a, const Board *b) {
+  size_t n = (size_t)a->width * (size_t)a->height;
+  size_t rows = (size_t)a->height * (size_t)a->bits.words;
+  int same = a->stats.occupied == b->stats.occupied &&
+             a->stats.free_value == b->stats.free_value &&
+             memcmp(a->cells, b->cells, n * sizeof(int)) == 0 &&
+             memcmp(a->stats.free_nbr, b->stats.free_nbr, n) == 0 &&
+             memcmp(a->bits.occ, b->bits.occ, rows * sizeof(uint64_t)) == 0 &&
+             memcmp(a->bits.heads, b->bits.heads, rows * sizeof(uint64_t)) == 0;
+  for (int p = 0; p < a->num_players; p++)
+    same = same && a->head_x[p] == b->head_x[p] &&
+           a->head_y[p] == b->head_y[p] && a->score[p] == b->score[p];
+  return same;
+}
+
+// The BRS search walks the tree with make/unmake, so board_undo_move must
+// restore everything board_apply_move touched: random move sequences are
+// applied and taken back, then compared with a copy of the start
+static int check_undo(Board *b, int sequences) {
+  Board ref;
+  if (board_init_storage(&ref, b->width, b->height) != 0)
+    return 0;
+  board_copy_into(&ref, b);
+  uint64_t seed = 99;
+  int ok = 1;
+  for (int s = 0; s < sequences && ok; s++) {
+    struct {
+      int p, fx, fy, value;
+    } undo[16];
+    int depth = 0;
+    int plies = 1 + (int)(splitmix(&seed) % 16);
+    for (int ply = 0; ply < plies; ply++) {
+      int p = (int)(splitmix(&seed) % (uint64_t)b->num_players);
+      CenteMove mv[8];
+      int n = board_legal_moves(b, p, mv, 8);
+      if (n == 0)
+        continue;
+      CenteMove m = mv[splitmix(&seed) % (uint64_t)n];
+      undo[depth].p = p;
+      undo[depth].fx = b->head_x[p];
+      undo[depth].fy = b->head_y[p];
+      undo[depth].value = b->cells[m.y * b->width + m.x];
+      depth++;
+      board_apply_move(b, p, m);
+    }
+    while (depth > 0) {
+      depth--;
+      board_undo_move(b, undo[depth].p, undo[depth].fx, undo[depth].fy,
+                      undo[depth].value);
+    }
+    ok = same_board(b, &ref);
+  }
+  board_free_storage(&ref);
+  printf("%2dx%-2d  apply/undo   %d sequences                %s\n", b->width,
+         b->height, sequences, ok ? "ok" : "MISMATCH");
+  return ok;
+}
+
+static int bench_size(int w, int h, int reps) {
+  const CenteKernels *fixed = kernels_lookup(w, h);
+  if (!fixed) {
+    fprintf(stderr, "cente_bench: no specialised kernels for %dx%d\n", w, h);
+    return 1;
+  }
+  Board *b = bench_board(w, h, (uint64_t)(w * 131 + h));
+  InfluenceMap *inf = influence_create_storage(w, h, 0);
+  if (!b || !inf) {
+    board_destroy(b);
+    influence_destroy(inf);
+    return 1;
+  }
+  compute_influence_full(b, 0, BENCH_SIGMA, inf);
+  BenchResult r[2];
+  int nr = 0;
+  // Sizes that keep the generic count_stats have nothing to compare
+  if (fixed->count_stats != kernels_generic()->count_stats)
+    bench_stats(fixed, b, reps, &r[nr++]);
+  bench_prior(fixed, b, inf, reps * 8, &r[nr++]);
+  int bad = 0;
+  for (int i = 0; i < nr; i++) {
+    report(w, h, &r[i]);
+    bad |= !r[i].same;
+  }
+  bad |= !check_undo(b, 1000);
+  influence_destroy(inf);
+  board_destroy(b);
+  return bad;
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr, "Usage: %s [-w width -h height] [-r reps]\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+  int w = 0, h = 0, reps = 20000;
+  int opt;
+  while ((opt = getopt(argc, argv, "w:h:r:")) != -1) {
+    switch (opt) {
+    case 'w':
+      w = atoi(optarg);
+      break;
+    case 'h':
+      h = atoi(optarg);
+      break;
+    case 'r':
+      reps = atoi(optarg);
+      break;
+    default:
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (reps < 1 || (w > 0) != (h > 0)) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  printf("size   kernel        generic ns   fixed ns   speedup\n");
+  int bad = 0;
+  if (w > 0) {
+    bad = bench_size(w, h, reps);
+  } else {
+#define BENCH_SIZE(W, H, S) bad |= bench_size(W, H, reps);
+    CENTE_KERNEL_SIZES(BENCH_SIZE)
+#undef BENCH_SIZE
+  }
+  return bad ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,125 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include "include/cente_bitboard.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Bits of the last word of a row that lie past the last column
+static uint64_t pad_mask(const BoardBits *bb) {
+  int used = bb->width - (bb->words - 1) * 64;
+  return used == 64 ? 0ULL : ~0ULL << used;
+}
+
+int bits_init(BoardBits *bb, int width, int height) {
+  bb->width = width;
+  bb->height = height;
+  bb->words = (width + 63) / 64;
+  size_t n = (size_t)height * (size_t)bb->words;
+  bb->occ = (uint64_t *)calloc(n, sizeof(uint64_t));
+  bb->heads = (uint64_t *)calloc(n, sizeof(uint64_t));
+  bb->tmp = (uint64_t *)calloc(3 * (size_t)bb->words, sizeof(uint64_t));
+  if (!bb->occ || !bb->heads || !bb->tmp) {
+    bits_free(bb);
+    return -1;
+  }
+  return 0;
+}
+
+void bits_free(BoardBits *bb) {
+  free(bb->occ);
+  free(bb->heads);
+  free(bb->tmp);
+  bb->occ = bb->heads = bb->tmp = NULL;
+}
+
+void bits_copy(BoardBits *dst, const BoardBits *src) {
+  size_t n = (size_t)src->height * (size_t)src->words * sizeof(uint64_t);
+  memcpy(dst->occ, src->occ, n);
+  memcpy(dst->heads, src->heads, n);
+}
+
+void bits_rebuild(BoardBits *bb, const int *cells) {
+  int w = bb->width;
+  uint64_t pad = pad_mask(bb);
+  for (int y = 0; y < bb->height; y++) {
+    uint64_t *row = bits_row(bb, bb->occ, y);
+    const int *c = cells + (size_t)y * (size_t)w;
+    for (int wi = 0; wi < bb->words; wi++) {
+      uint64_t v = 0;
+      int x0 = wi * 64;
+      int x1 = x0 + 64 < w ? x0 + 64 : w;
+      for (int x = x0; x < x1; x++)
+        v |= (uint64_t)(c[x] <= 0) << (x - x0);
+      row[wi] = v;
+    }
+    row[bb->words - 1] |= pad;
+  }
+  memset(bb->heads, 0,
+         (size_t)bb->height * (size_t)bb->words * sizeof(uint64_t));
+}
+
+// Occupancy of columns x-1, x, x+1 in bits 0..2; off-board reads as occupied
+static unsigned occ3(const BoardBits *bb, int x, int y) {
+  if (y < 0 || y >= bb->height)
+    return 7u;
+  const uint64_t *row = bits_row(bb, bb->occ, y);
+  if (x == 0)
+    return 1u | (unsigned)((row[0] & 3ULL) << 1);
+  int b = x - 1, wi = b >> 6, sh = b & 63;
+  uint64_t v = row[wi] >> sh;
+  if (sh > 61)
+    v |= wi + 1 < bb->words ? row[wi + 1] << (64 - sh) : ~0ULL << (64 - sh);
+  return (unsigned)v & 7u;
+}
+
+unsigned bits_free8(const BoardBits *bb, int x, int y) {
+  unsigned up = ~occ3(bb, x, y - 1) & 7u;
+  unsigned mid = ~occ3(bb, x, y) & 7u;
+  unsigned dn = ~occ3(bb, x, y + 1) & 7u;
+  // N, NE, E, SE, S, SW, W, NW
+  return ((up >> 1) & 1u) | (((up >> 2) & 1u) << 1) |
+         (((mid >> 2) & 1u) << 2) | (((dn >> 2) & 1u) << 3) |
+         (((dn >> 1) & 1u) << 4) | ((dn & 1u) << 5) | ((mid & 1u) << 6) |
+         ((up & 1u) << 7);
+}
+
+// Horizontal dilation of one row: in | in<<1 | in>>1, carrying across words
+static void dilate_row(const uint64_t *in, uint64_t *out, int words) {
+  for (int i = 0; i < words; i++) {
+    uint64_t l = in[i] << 1, r = in[i] >> 1;
+    if (i > 0)
+      l |= in[i - 1] >> 63;
+    if (i + 1 < words)
+      r |= in[i + 1] << 63;
+    out[i] = in[i] | l | r;
+  }
+}
+
+void bits_expand_free(BoardBits *bb, const uint64_t *src, uint64_t *dst) {
+  int words = bb->words, h = bb->height;
+  uint64_t *prev = bb->tmp, *cur = bb->tmp + words, *next = bb->tmp + 2 * words;
+  memset(prev, 0, (size_t)words * sizeof(uint64_t));
+  dilate_row(bits_row(bb, src, 0), cur, words);
+  for (int y = 0; y < h; y++) {
+    if (y + 1 < h)
+      dilate_row(bits_row(bb, src, y + 1), next, words);
+    else
+      memset(next, 0, (size_t)words * sizeof(uint64_t));
+    const uint64_t *occ = bits_row(bb, bb->occ, y);
+    uint64_t *out = bits_row(bb, dst, y);
+    for (int i = 0; i < words; i++)
+      out[i] = (prev[i] | cur[i] | next[i]) & ~occ[i];
+    uint64_t *t = prev;
+    prev = cur;
+    cur = next;
+    next = t;
+  }
+}
+
+int bits_count(const BoardBits *bb, const uint64_t *m) {
+  size_t n = (size_t)bb->height * (size_t)bb->words;
+  int k = 0;
+  for (size_t i = 0; i < n; i++)
+    k += __builtin_popcountll(m[i]);
+  return k;
+}
@@ -1,6 +1,7 @@
 // This is a personal academic project. Dear PVS-Studio, please check it.
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 #include "include/cente_board.h"
+#include "include/cente_kernels.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -15,8 +16,10 @@ Board *board_create_from_shared(int width, int height, int num_players,
   Board *b = (Board *)calloc(1, sizeof(Board));
   if (!b)
     return NULL;
-  b->width = width;
-  b->height = height;
+  if (board_init_storage(b, width, height) != 0) {
+    free(b);
+    return NULL;
+  }
   b->num_players = num_players;
   b->current_player = self_player;
   for (int i = 0; i < num_players; i++) {
@@ -25,66 +28,177 @@ Board *board_create_from_shared(int width, int height, int num_players,
     b->blocked[i] = blocked[i];
     b->score[i] = score[i];
   }
-  size_t n = (size_t)width * (size_t)height;
-  b->cells = (int *)malloc(n * sizeof(int));
-  if (!b->cells) {
-    free(b);
-    return NULL;
-  }
-  memcpy(b->cells, cells, n * sizeof(int));
+  memcpy(b->cells, cells, (size_t)width * (size_t)height * sizeof(int));
+  board_stats_rebuild(b);
   return b;
 }
 
 void board_destroy(Board *b) {
   if (!b)
     return;
-  free(b->cells);
+  board_free_storage(b);
   free(b);
 }
 
+int board_init_storage(Board *b, int width, int height) {
+  size_t n = (size_t)width * (size_t)height;
+  b->width = width;
+  b->height = height;
+  b->cells = (int *)calloc(n, sizeof(int));
+  b->stats.free_nbr = (unsigned char *)calloc(n, 1);
+  b->stats.occupied = (int)n;
+  b->stats.free_value = 0;
+  int rc = bits_init(&b->bits, width, height);
+  if (!b->cells || !b->stats.free_nbr || rc != 0) {
+    board_free_storage(b);
+    return -1;
+  }
+  return 0;
+}
+
+void board_free_storage(Board *b) {
+  free(b->cells);
+  free(b->stats.free_nbr);
+  b->cells = NULL;
+  b->stats.free_nbr = NULL;
+  bits_free(&b->bits);
+}
+
+void board_copy_into(Board *dst, const Board *src) {
+  int *cells = dst->cells;
+  unsigned char *nbr = dst->stats.free_nbr;
+  BoardBits bits = dst->bits;
+  size_t n = (size_t)src->width * (size_t)src->height;
+  *dst = *src;
+  dst->cells = cells;
+  dst->stats.free_nbr = nbr;
+  dst->bits = bits;
+  memcpy(dst->cells, src->cells, n * sizeof(int));
+  memcpy(dst->stats.free_nbr, src->stats.free_nbr, n);
+  bits_copy(&dst->bits, &src->bits);
+}
+
+// Free neighbours of cell i = (x, y) on a w x h board
+CENTE_FORCE_INLINE int count_free_nbr(const int *cells, int i, int x, int y,
+                                      const int w, const int h) {
+  if (x > 0 && y > 0 && x < w - 1 && y < h - 1)
+    return (cells[i - w - 1] > 0) + (cells[i - w] > 0) +
+           (cells[i - w + 1] > 0) + (cells[i - 1] > 0) + (cells[i + 1] > 0) +
+           (cells[i + w - 1] > 0) + (cells[i + w] > 0) + (cells[i + w + 1] > 0);
+  int k = 0;
+  for (int ny = y - 1; ny <= y + 1; ny++)
+    for (int nx = x - 1; nx <= x + 1; nx++)
+      if ((nx != x || ny != y) && nx >= 0 && ny >= 0 && nx < w && ny < h &&
+          cells[ny * w + nx] > 0)
+        k++;
+  return k;
+}
+
+CENTE_FORCE_INLINE void count_stats_impl(Board *b, const int w, const int h) {
+  BoardStats *st = &b->stats;
+  const int *cells = b->cells;
+  int occupied = 0;
+  long long free_value = 0;
+  for (int y = 0; y < h; y++)
+    for (int x = 0; x < w; x++) {
+      int i = y * w + x;
+      int v = cells[i];
+      if (v <= 0)
+        occupied++;
+      else
+        free_value += v;
+      st->free_nbr[i] = (unsigned char)count_free_nbr(cells, i, x, y, w, h);
+    }
+  st->occupied = occupied;
+  st->free_value = free_value;
+}
+
+#define COUNT_STATS_VARIANT(W, H)                                              \
+  void board_count_stats_##W##x##H(Board *b) { count_stats_impl(b, W, H); }
+CENTE_COUNT_STATS_SIZES(COUNT_STATS_VARIANT)
+
+void board_count_stats_generic(Board *b) {
+  count_stats_impl(b, b->width, b->height);
+}
+
+void board_stats_rebuild(Board *b) {
+  kernels_for(b->width, b->height)->count_stats(b);
+  bits_rebuild(&b->bits, b->cells);
+  for (int p = 0; p < b->num_players; p++)
+    bits_set(&b->bits, b->bits.heads, b->head_x[p], b->head_y[p]);
+}
+
+void board_set_head(Board *b, int player_id, int x, int y) {
+  bits_clear(&b->bits, b->bits.heads, b->head_x[player_id],
+             b->head_y[player_id]);
+  b->head_x[player_id] = (unsigned short)x;
+  b->head_y[player_id] = (unsigned short)y;
+  bits_set(&b->bits, b->bits.heads, x, y);
+}
+
+void board_occupy(Board *b, int i, int value) {
+  int old = b->cells[i];
+  b->cells[i] = value;
+  if (old <= 0)
+    return;
+  BoardStats *st = &b->stats;
+  int w = b->width;
+  int x = i % w, y = i / w;
+  bits_set(&b->bits, b->bits.occ, x, y);
+  st->occupied++;
+  st->free_value -= old;
+  int x0 = x > 0 ? x - 1 : x, x1 = x < w - 1 ? x + 1 : x;
+  int y0 = y > 0 ? y - 1 : y, y1 = y < b->height - 1 ? y + 1 : y;
+  for (int ny = y0; ny <= y1; ny++)
+    for (int nx = x0; nx <= x1; nx++)
+      st->free_nbr[ny * w + nx]--;
+  // The loop also counted the cell itself
+  st->free_nbr[i]++;
+}
+
 bool board_is_inside(const Board *b, int x, int y) {
   return x >= 0 && x < b->width && y >= 0 && y < b->height;
 }
 
-static bool occupied_or_blocked(const Board *b, int x, int y, int self_id) {
-  int cell = b->cells[idx(b, x, y)];
-  if (cell <= 0)
-    return true;
-  for (int j = 0; j < b->num_players; j++) {
-    if (j == self_id)
-      continue;
-    if (!b->blocked[j] && b->head_x[j] == (unsigned short)x &&
-        b->head_y[j] == (unsigned short)y) {
-      return true;
-    }
-  }
-  return false;
+// Heads are stored as -pid, so every head is already an occupied cell
+static bool occupied_or_blocked(const Board *b, int x, int y) {
+  return b->cells[idx(b, x, y)] <= 0;
 }
 
 bool board_is_legal(const Board *b, int player_id, CenteMove m) {
   if (!board_is_inside(b, m.x, m.y))
     return false;
-  return !occupied_or_blocked(b, m.x, m.y, player_id);
+  (void)player_id;
+  return !occupied_or_blocked(b, m.x, m.y);
 }
 
 int board_legal_moves(const Board *b, int player_id, CenteMove out[],
                       int max_out) {
   static const int dx[8] = {0, 1, 1, 1, 0, -1, -1, -1};
   static const int dy[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+  const int w = b->width, h = b->height;
   int x = b->head_x[player_id];
   int y = b->head_y[player_id];
+  unsigned free8;
+  if (x > 0 && y > 0 && x < w - 1 && y < h - 1) {
+    // Away from the border the neighbours are fixed offsets from the head
+    const int *c = b->cells + y * w + x;
+    free8 = (unsigned)(c[-w] > 0) | (unsigned)(c[-w + 1] > 0) << 1 |
+            (unsigned)(c[1] > 0) << 2 | (unsigned)(c[w + 1] > 0) << 3 |
+            (unsigned)(c[w] > 0) << 4 | (unsigned)(c[w - 1] > 0) << 5 |
+            (unsigned)(c[-1] > 0) << 6 | (unsigned)(c[-w - 1] > 0) << 7;
+  } else {
+    free8 = bits_free8(&b->bits, x, y);
+  }
   int k = 0;
   for (int d = 0; d < 8; d++) {
-    int nx = x + dx[d];
-    int ny = y + dy[d];
-    if (board_is_inside(b, nx, ny) &&
-        !occupied_or_blocked(b, nx, ny, player_id)) {
-      if (k < max_out) {
-        out[k].x = nx;
-        out[k].y = ny;
-      }
-      k++;
+    if (!(free8 & (1u << d)))
+      continue;
+    if (k < max_out) {
+      out[k].x = x + dx[d];
+      out[k].y = y + dy[d];
     }
+    k++;
   }
   return k;
 }
@@ -96,10 +210,37 @@ void board_apply_move(Board *b, int player_id, CenteMove m) {
   int val = b->cells[dest];
   if (val > 0)
     b->score[player_id] += (unsigned int)val;
-  b->cells[idx(b, x, y)] = -player_id;
-  b->head_x[player_id] = (unsigned short)m.x;
-  b->head_y[player_id] = (unsigned short)m.y;
-  b->cells[dest] = -player_id;
+  board_occupy(b, idx(b, x, y), -player_id);
+  board_set_head(b, player_id, m.x, m.y);
+  board_occupy(b, dest, -player_id);
+}
+
+// Inverse of board_occupy for a cell that held `value` (> 0) before
+static void board_release(Board *b, int i, int value) {
+  b->cells[i] = value;
+  if (value <= 0)
+    return;
+  BoardStats *st = &b->stats;
+  int w = b->width;
+  int x = i % w, y = i / w;
+  bits_clear(&b->bits, b->bits.occ, x, y);
+  st->occupied--;
+  st->free_value += value;
+  int x0 = x > 0 ? x - 1 : x, x1 = x < w - 1 ? x + 1 : x;
+  int y0 = y > 0 ? y - 1 : y, y1 = y < b->height - 1 ? y + 1 : y;
+  for (int ny = y0; ny <= y1; ny++)
+    for (int nx = x0; nx <= x1; nx++)
+      st->free_nbr[ny * w + nx]++;
+  st->free_nbr[i]--;
+}
+
+void board_undo_move(Board *b, int player_id, int from_x, int from_y,
+                     int dest_value) {
+  int dest = idx(b, b->head_x[player_id], b->head_y[player_id]);
+  if (dest_value > 0)
+    b->score[player_id] -= (unsigned int)dest_value;
+  board_set_head(b, player_id, from_x, from_y);
+  board_release(b, dest, dest_value);
 }
 
 // Simple Zobrist-like rolling hash based on cell occupancy and heads
@@ -0,0 +1,206 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include "include/cente_book.h"
+#include "include/cente_config.h"
+#include "include/cente_zobrist.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct CenteBook {
+  void *map;
+  size_t len;
+  const CenteBookEntry *entries;
+  size_t count;
+  int max_occupied;
+};
+
+static const int DX[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+static const int DY[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+
+CenteBook *book_open(const char *path, int width, int height, int players) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return NULL;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CenteBookHeader)) {
+    close(fd);
+    return NULL;
+  }
+  size_t len = (size_t)st.st_size;
+  void *map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+    return NULL;
+  const CenteBookHeader *hd = (const CenteBookHeader *)map;
+  CenteBook *book = NULL;
+  if (memcmp(hd->magic, CENTE_BOOK_MAGIC, sizeof(hd->magic)) == 0 &&
+      hd->width == (uint32_t)width && hd->height == (uint32_t)height &&
+      hd->players == (uint32_t)players &&
+      hd->value_radius == (uint32_t)CENTE_BOOK_VALUE_RADIUS &&
+      hd->count <= (len - sizeof(*hd)) / sizeof(CenteBookEntry))
+    book = (CenteBook *)malloc(sizeof(CenteBook));
+  if (!book) {
+    munmap(map, len);
+    return NULL;
+  }
+  book->map = map;
+  book->len = len;
+  book->entries = (const CenteBookEntry *)(hd + 1);
+  book->count = (size_t)hd->count;
+  book->max_occupied = (int)hd->max_occupied;
+  return book;
+}
+
+CenteBook *book_open_default(int width, int height, int players) {
+  if (width * height > CENTE_BOOK_MAX_AREA)
+    return NULL;
+  const char *env = getenv("CENTE_BOOK");
+  if (env && *env)
+    return book_open(env, width, height, players);
+  char path[256];
+  snprintf(path, sizeof(path), "%s/cente_%dx%d_%d.book", CENTE_BOOK_DIR,
+           width, height, players);
+  return book_open(path, width, height, players);
+}
+
+void book_close(CenteBook *book) {
+  if (!book)
+    return;
+  munmap(book->map, book->len);
+  free(book);
+}
+
+// Key of value v on cell i (in the symmetry's frame)
+static uint64_t value_key(size_t i, int v) {
+  uint64_t z = ((uint64_t)i << 4 | (uint64_t)v) + 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+static int near_head(const Board *b, int x, int y) {
+  for (int p = 0; p < b->num_players; p++)
+    if (abs(x - b->head_x[p]) <= CENTE_BOOK_VALUE_RADIUS &&
+        abs(y - b->head_y[p]) <= CENTE_BOOK_VALUE_RADIUS)
+      return 1;
+  return 0;
+}
+
+uint64_t book_key(const Board *b, int *sym) {
+  int w = b->width, h = b->height;
+  int syms = zobrist_sym_count(w, h);
+  uint64_t keys[8];
+  for (int s = 0; s < syms; s++)
+    keys[s] = zobrist_hash_sym(b, s);
+  // The heads open the game on random values: hashing the ones in reach
+  // keeps a move searched on one board from being replayed on another
+  for (int y = 0; y < h; y++)
+    for (int x = 0; x < w; x++) {
+      int v = b->cells[y * w + x];
+      if (v <= 0 || !near_head(b, x, y))
+        continue;
+      for (int s = 0; s < syms; s++) {
+        int tx, ty;
+        zobrist_sym_point(s, w, h, x, y, &tx, &ty);
+        keys[s] ^= value_key((size_t)ty * (size_t)w + (size_t)tx, v);
+      }
+    }
+  uint64_t best = keys[0];
+  int best_s = 0;
+  for (int s = 1; s < syms; s++) {
+    if (keys[s] < best) {
+      best = keys[s];
+      best_s = s;
+    }
+  }
+  if (sym)
+    *sym = best_s;
+  return best;
+}
+
+// Directions transform like points about the origin
+static void sym_vector(int sym, int *dx, int *dy) {
+  if (sym & 4) {
+    int t = *dx;
+    *dx = *dy;
+    *dy = t;
+  }
+  if (sym & 1)
+    *dx = -*dx;
+  if (sym & 2)
+    *dy = -*dy;
+}
+
+int book_dir_to_canon(int sym, int dir) {
+  int dx = DX[dir], dy = DY[dir];
+  sym_vector(sym, &dx, &dy);
+  for (int d = 0; d < 8; d++)
+    if (DX[d] == dx && DY[d] == dy)
+      return d;
+  return -1;
+}
+
+int book_dir_from_canon(int sym, int dir) {
+  for (int d = 0; d < 8; d++)
+    if (book_dir_to_canon(sym, d) == dir)
+      return d;
+  return -1;
+}
+
+int book_probe(const CenteBook *book, const Board *b, int self_id,
+               CenteMove *out) {
+  if (!book || b->stats.occupied > book->max_occupied ||
+      b->current_player != self_id)
+    return 0;
+  int sym;
+  uint64_t key = book_key(b, &sym);
+  size_t lo = 0, hi = book->count;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (book->entries[mid].key < key)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo == book->count || book->entries[lo].key != key)
+    return 0;
+  int d = book_dir_from_canon(sym, book->entries[lo].dir & 7);
+  CenteMove m = {b->head_x[self_id] + DX[d], b->head_y[self_id] + DY[d]};
+  if (!board_is_legal(b, self_id, m))
+    return 0;
+  *out = m;
+  return 1;
+}
+
+static int entry_cmp(const void *a, const void *b) {
+  uint64_t ka = ((const CenteBookEntry *)a)->key;
+  uint64_t kb = ((const CenteBookEntry *)b)->key;
+  return (ka > kb) - (ka < kb);
+}
+
+int book_write(const char *path, int width, int height, int players,
+               int max_occupied, CenteBookEntry *entries, size_t count) {
+  qsort(entries, count, sizeof(CenteBookEntry), entry_cmp);
+  CenteBookHeader hd;
+  memset(&hd, 0, sizeof(hd));
+  memcpy(hd.magic, CENTE_BOOK_MAGIC, sizeof(hd.magic));
+  hd.width = (uint32_t)width;
+  hd.height = (uint32_t)height;
+  hd.players = (uint32_t)players;
+  hd.max_occupied = (uint32_t)max_occupied;
+  hd.value_radius = (uint32_t)CENTE_BOOK_VALUE_RADIUS;
+  hd.count = (uint64_t)count;
+  FILE *f = fopen(path, "wb");
+  if (!f)
+    return -1;
+  int ok = fwrite(&hd, sizeof(hd), 1, f) == 1 &&
+           fwrite(entries, sizeof(CenteBookEntry), count, f) == count;
+  if (fclose(f) != 0)
+    ok = 0;
+  return ok ? 0 : -1;
+}
@@ -0,0 +1,254 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+// Offline opening book builder: replays the master's board setup for a given
+// size, lets every seat search the first rounds deeply and writes the
+// aggregated root visits as a book for player_cente (see cente_book.h).
+// Keys include the values around the heads, so a book only answers on the
+// seeds it was built from (or boards that happen to match near the heads).
+#include "include/cente_board.h"
+#include "include/cente_book.h"
+#include "include/cente_config.h"
+#include "include/cente_eval.h"
+#include "include/cente_kernels.h"
+#include "include/cente_influence.h"
+#include "include/cente_mcts.h"
+#include "include/cente_zobrist.h"
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Deep searches need a bigger arena than a turn does
+#define BOOK_TREE_NODES 200000
+
+typedef struct {
+  CenteBookEntry *v;
+  size_t n, cap;
+} EntryVec;
+
+static int push_entry(EntryVec *ev, uint64_t key, int dir, int weight) {
+  if (ev->n == ev->cap) {
+    size_t cap = ev->cap ? 2 * ev->cap : 1024;
+    CenteBookEntry *v =
+        (CenteBookEntry *)realloc(ev->v, cap * sizeof(CenteBookEntry));
+    if (!v)
+      return -1;
+    ev->v = v;
+    ev->cap = cap;
+  }
+  CenteBookEntry *e = &ev->v[ev->n++];
+  memset(e, 0, sizeof(*e));
+  e->key = key;
+  e->dir = (uint8_t)dir;
+  e->weight = (uint32_t)weight;
+  return 0;
+}
+
+static int key_dir_cmp(const void *a, const void *b) {
+  const CenteBookEntry *x = (const CenteBookEntry *)a;
+  const CenteBookEntry *y = (const CenteBookEntry *)b;
+  if (x->key != y->key)
+    return (x->key > y->key) - (x->key < y->key);
+  return (int)x->dir - (int)y->dir;
+}
+
+// Sums the weight of every (key, dir) sample and keeps the heaviest move per
+// key, in place. Returns the number of positions left.
+static size_t aggregate(EntryVec *ev) {
+  qsort(ev->v, ev->n, sizeof(CenteBookEntry), key_dir_cmp);
+  size_t out = 0;
+  for (size_t i = 0; i < ev->n;) {
+    uint64_t key = ev->v[i].key;
+    CenteBookEntry best = ev->v[i];
+    best.weight = 0;
+    while (i < ev->n && ev->v[i].key == key) {
+      CenteBookEntry cur = ev->v[i];
+      cur.weight = 0;
+      for (; i < ev->n && ev->v[i].key == key && ev->v[i].dir == cur.dir; i++)
+        cur.weight += ev->v[i].weight;
+      if (cur.weight > best.weight)
+        best = cur;
+    }
+    if (best.weight > 0)
+      ev->v[out++] = best;
+  }
+  ev->n = out;
+  return out;
+}
+
+// Same draws as initialize_players: rand() before the master seeds it
+static void start_heads(int w, int h, int players, unsigned short *hx,
+                        unsigned short *hy) {
+  srand(1);
+  for (int i = 0; i < players; i++) {
+    int ok;
+    do {
+      ok = 1;
+      hx[i] = (unsigned short)(rand() % w);
+      hy[i] = (unsigned short)(rand() % h);
+      for (int j = 0; j < i; j++)
+        if (hx[i] == hx[j] && hy[i] == hy[j]) {
+          ok = 0;
+          break;
+        }
+    } while (!ok);
+  }
+}
+
+static int dir_of(const Board *b, int p, CenteMove m) {
+  static const int dx[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+  static const int dy[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+  for (int d = 0; d < 8; d++)
+    if (b->head_x[p] + dx[d] == m.x && b->head_y[p] + dy[d] == m.y)
+      return d;
+  return -1;
+}
+
+// Plays `rounds` rounds of self-play on the board drawn from `seed`,
+// recording the root visits of every search. Returns -1 on allocation failure.
+static int play_seed(int w, int h, int players, int seed, int rounds,
+                     int ms, EntryVec *ev, int *max_occupied) {
+  size_t n = (size_t)w * (size_t)h;
+  int *cells = (int *)malloc(n * sizeof(int));
+  unsigned short hx[CENTE_MAX_PLAYERS], hy[CENTE_MAX_PLAYERS];
+  unsigned char blocked[CENTE_MAX_PLAYERS] = {0};
+  unsigned int score[CENTE_MAX_PLAYERS] = {0};
+  if (!cells)
+    return -1;
+  start_heads(w, h, players, hx, hy);
+  srand((unsigned int)seed);
+  for (size_t i = 0; i < n; i++)
+    cells[i] = (rand() % 9) + 1;
+  for (int i = 0; i < players; i++)
+    cells[hy[i] * w + hx[i]] = -i;
+
+  Board *b = board_create_from_shared(w, h, players, hx, hy, blocked, score,
+                                      cells, 0);
+  free(cells);
+  InfluenceMap *inf = influence_create(w, h);
+  // A fresh tree per seed: the tree's hash ignores cell values, so a root
+  // kept from another seed would carry statistics for a different board
+  MCTSTree *tree = mcts_tree_create(w, h, BOOK_TREE_NODES);
+  int rc = 0;
+  if (!b || !inf || !tree)
+    rc = -1;
+
+  CenteParams params;
+  cente_params_defaults(&params);
+  cente_size_params sp = cente_params_for_size(&params, w, h);
+  CenteBudget budget = cente_budget_fixed(ms);
+  CenteMove moves[CENTE_MAX_CHILDREN];
+  int visits[CENTE_MAX_CHILDREN];
+  CenteMove legal[8];
+  for (int r = 0; r < rounds && rc == 0; r++) {
+    // The master applies each move as it arrives, so every seat searches the
+    // board left by the seats before it (taken here in seat order)
+    for (int p = 0; p < players && rc == 0; p++) {
+      if (b->blocked[p])
+        continue;
+      if (board_legal_moves(b, p, legal, 8) == 0) {
+        b->blocked[p] = 1;
+        continue;
+      }
+      b->current_player = p;
+      compute_influence_full(b, p, sp.sigma, inf);
+      cente_phase ph;
+      cente_weights wts;
+      phase_detect(b, inf, &params, &ph, &wts);
+      mcts_tree_set_root(tree, b, p);
+      CenteMove chosen =
+          mcts_search(tree, b, p, inf, &wts, &sp.mcts, &budget, NULL);
+
+      int sym;
+      uint64_t key = book_key(b, &sym);
+      int k = mcts_root_visits(tree, moves, visits, CENTE_MAX_CHILDREN);
+      for (int i = 0; i < k && rc == 0; i++) {
+        int d = dir_of(b, p, moves[i]);
+        if (d >= 0 && visits[i] > 0)
+          rc = push_entry(ev, key, book_dir_to_canon(sym, d), visits[i]);
+      }
+      if (b->stats.occupied > *max_occupied)
+        *max_occupied = b->stats.occupied;
+      if (board_is_legal(b, p, chosen))
+        board_apply_move(b, p, chosen);
+    }
+  }
+  mcts_tree_destroy(tree);
+  influence_destroy(inf);
+  board_destroy(b);
+  return rc;
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [-w width] [-h height] [-p players] [-r rounds] "
+          "[-n seeds] [-t ms] -o file\n"
+          "  -r rounds  moves per player searched from each start (default 4)\n"
+          "  -n seeds   board seeds 1..n sampled (default 8)\n"
+          "  -t ms      search time per position (default 1000)\n",
+          prog);
+}
+
+int main(int argc, char *argv[]) {
+  int w = 10, h = 10, players = 2, rounds = 4, seeds = 8, ms = 1000;
+  const char *out = NULL;
+  int opt;
+  while ((opt = getopt(argc, argv, "w:h:p:r:n:t:o:")) != -1) {
+    switch (opt) {
+    case 'w':
+      w = atoi(optarg);
+      break;
+    case 'h':
+      h = atoi(optarg);
+      break;
+    case 'p':
+      players = atoi(optarg);
+      break;
+    case 'r':
+      rounds = atoi(optarg);
+      break;
+    case 'n':
+      seeds = atoi(optarg);
+      break;
+    case 't':
+      ms = atoi(optarg);
+      break;
+    case 'o':
+      out = optarg;
+      break;
+    default:
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (!out || w < 1 || h < 1 || players < 1 || players > CENTE_MAX_PLAYERS ||
+      w * h < players || rounds < 1 || seeds < 1 || ms < 1) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (w * h > CENTE_BOOK_MAX_AREA)
+    fprintf(stderr, "cente_book: warning: %dx%d exceeds CENTE_BOOK_MAX_AREA, "
+                    "player_cente will not load this book\n",
+            w, h);
+
+  zobrist_init(w, h, players);
+  kernels_init(w, h);
+  EntryVec ev = {NULL, 0, 0};
+  int max_occupied = 0;
+  for (int s = 1; s <= seeds; s++) {
+    if (play_seed(w, h, players, s, rounds, ms, &ev, &max_occupied) != 0) {
+      fprintf(stderr, "cente_book: out of memory\n");
+      free(ev.v);
+      return EXIT_FAILURE;
+    }
+    fprintf(stderr, "cente_book: seed %d/%d, %zu samples\n", s, seeds, ev.n);
+  }
+  size_t count = aggregate(&ev);
+  int rc = book_write(out, w, h, players, max_occupied, ev.v, count);
+  if (rc != 0)
+    perror("cente_book");
+  else
+    printf("cente_book: %zu positions written to %s\n", count, out);
+  free(ev.v);
+  return rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,234 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include "include/cente_brs.h"
+#include "include/cente_voronoi.h"
+#include <stdlib.h>
+
+// Below every live leaf (values lie in [0,1]); dying later scores higher
+#define BRS_DEAD (-1.0f)
+#define BRS_INF 1e30f
+
+typedef struct {
+  int player;
+  CenteMove move;
+  float danger;
+} BrsReply;
+
+struct CenteBrs {
+  Board board; // make/unmake search board, cells owned here
+  VoronoiScratch *voronoi;
+  const InfluenceMap *inf;
+  const cente_weights *w;
+  int self_id;
+  unsigned long long deadline_ms;
+  int aborted;
+  long nodes;
+  int depth_done;
+};
+
+CenteBrs *brs_create(int width, int height) {
+  CenteBrs *s = (CenteBrs *)calloc(1, sizeof(CenteBrs));
+  if (!s)
+    return NULL;
+  s->voronoi = voronoi_create(width, height);
+  if (!s->voronoi || board_init_storage(&s->board, width, height) != 0) {
+    brs_destroy(s);
+    return NULL;
+  }
+  return s;
+}
+
+void brs_destroy(CenteBrs *s) {
+  if (!s)
+    return;
+  board_free_storage(&s->board);
+  voronoi_destroy(s->voronoi);
+  free(s);
+}
+
+int brs_last_depth(const CenteBrs *s) { return s->depth_done; }
+long brs_last_nodes(const CenteBrs *s) { return s->nodes; }
+
+static int out_of_time(CenteBrs *s) {
+  if (!s->aborted && (++s->nodes & 255) == 0 &&
+      cente_now_ms() >= s->deadline_ms)
+    s->aborted = 1;
+  return s->aborted;
+}
+
+static float leaf_value(CenteBrs *s, Board *b) {
+  float v = value_eval(b, s->self_id, s->inf, s->w);
+  if (CENTE_VORONOI_WEIGHT <= 0.0f)
+    return v;
+  VoronoiResult vr;
+  voronoi_eval(b, s->voronoi, &vr);
+  long long total = 0;
+  for (int p = 0; p < b->num_players; p++)
+    total += vr.value[p];
+  float share = total > 0 ? (float)vr.value[s->self_id] / (float)total : 0.0f;
+  return (1.0f - CENTE_VORONOI_WEIGHT) * v + CENTE_VORONOI_WEIGHT * share;
+}
+
+// Opponent moves that hurt us most first: taking one of our liberties, then
+// closing in on our head, then invading cells under our influence
+static float reply_danger(const Board *b, const InfluenceMap *inf, int self_id,
+                          CenteMove m) {
+  int dx = abs(m.x - b->head_x[self_id]), dy = abs(m.y - b->head_y[self_id]);
+  int d = dx > dy ? dx : dy;
+  int v = b->cells[m.y * b->width + m.x];
+  return (d <= 1 ? 2.0f : 0.0f) + 1.0f / (float)(1 + d) +
+         influence_you(inf, m.y * b->width + m.x) +
+         (v > 0 ? 0.25f * (float)v / 255.0f : 0.0f);
+}
+
+// The CENTE_BRS_REPLIES most dangerous moves over every live opponent
+static int gen_replies(const CenteBrs *s, const Board *b, BrsReply *out) {
+  int n = 0;
+  for (int p = 0; p < b->num_players; p++) {
+    if (p == s->self_id || b->blocked[p])
+      continue;
+    CenteMove mv[8];
+    int k = board_legal_moves(b, p, mv, 8);
+    for (int j = 0; j < k; j++) {
+      float dg = reply_danger(b, s->inf, s->self_id, mv[j]);
+      if (n == CENTE_BRS_REPLIES && dg <= out[n - 1].danger)
+        continue;
+      int i = n < CENTE_BRS_REPLIES ? n++ : n - 1;
+      for (; i > 0 && out[i - 1].danger < dg; i--)
+        out[i] = out[i - 1];
+      out[i] = (BrsReply){p, mv[j], dg};
+    }
+  }
+  return n;
+}
+
+static float brs_min(CenteBrs *s, Board *b, int depth, int ply, float alpha,
+                     float beta);
+
+// Our layer
+static float brs_max(CenteBrs *s, Board *b, int depth, int ply, float alpha,
+                     float beta) {
+  int self = s->self_id;
+  CenteMove mv[8];
+  int n = board_legal_moves(b, self, mv, 8);
+  if (n == 0)
+    return BRS_DEAD + 1e-3f * (float)ply;
+  if (depth == 0)
+    return leaf_value(s, b);
+  prior_cente_order(b, s->inf, mv, n);
+  float best = -BRS_INF;
+  int fx = b->head_x[self], fy = b->head_y[self];
+  for (int i = 0; i < n; i++) {
+    int dv = b->cells[mv[i].y * b->width + mv[i].x];
+    board_apply_move(b, self, mv[i]);
+    float v = brs_min(s, b, depth - 1, ply + 1, alpha, beta);
+    board_undo_move(b, self, fx, fy, dv);
+    if (out_of_time(s))
+      return best;
+    if (v > best)
+      best = v;
+    if (best > alpha)
+      alpha = best;
+    if (alpha >= beta)
+      break;
+  }
+  return best;
+}
+
+// Opponent layer: one opponent replies, the rest stand still
+static float brs_min(CenteBrs *s, Board *b, int depth, int ply, float alpha,
+                     float beta) {
+  if (depth == 0) {
+    CenteMove mv[8];
+    if (board_legal_moves(b, s->self_id, mv, 8) == 0)
+      return BRS_DEAD + 1e-3f * (float)ply;
+    return leaf_value(s, b);
+  }
+  BrsReply r[CENTE_BRS_REPLIES];
+  int n = gen_replies(s, b, r);
+  if (n == 0)
+    return brs_max(s, b, depth - 1, ply + 1, alpha, beta);
+  float best = BRS_INF;
+  for (int i = 0; i < n; i++) {
+    int p = r[i].player;
+    int fx = b->head_x[p], fy = b->head_y[p];
+    int dv = b->cells[r[i].move.y * b->width + r[i].move.x];
+    board_apply_move(b, p, r[i].move);
+    float v = brs_max(s, b, depth - 1, ply + 1, alpha, beta);
+    board_undo_move(b, p, fx, fy, dv);
+    if (out_of_time(s))
+      return best;
+    if (v < best)
+      best = v;
+    if (best < beta)
+      beta = best;
+    if (alpha >= beta)
+      break;
+  }
+  return best;
+}
+
+CenteMove brs_search(CenteBrs *s, const Board *root, int self_id,
+                     const InfluenceMap *inf, const cente_weights *w,
+                     const CenteBudget *budget) {
+  unsigned long long start = cente_now_ms();
+  CenteMove best = {root->head_x[self_id], root->head_y[self_id]};
+  Board *b = &s->board;
+  board_copy_into(b, root);
+  s->inf = inf;
+  s->w = w;
+  s->self_id = self_id;
+  s->nodes = 0;
+  s->depth_done = 0;
+  eval_init(root->width, root->height);
+
+  CenteMove mv[8];
+  int n = board_legal_moves(b, self_id, mv, 8);
+  if (n == 0)
+    return best;
+  prior_cente_order(b, inf, mv, n);
+  best = mv[0];
+  if (n == 1)
+    return best;
+
+  int fx = b->head_x[self_id], fy = b->head_y[self_id];
+  // Depth 1 always completes; deeper iterations stop at the soft limit and
+  // are only started while a good share of it is left
+  for (int depth = 1; depth <= CENTE_BRS_MAX_DEPTH;
+       depth += depth == 1 ? 1 : 2) {
+    unsigned long long now = cente_now_ms();
+    if (depth > 1 && now - start >= (unsigned long long)budget->soft_ms * 2 / 5)
+      break;
+    s->deadline_ms = depth == 1 ? ~0ULL : start + (unsigned long long)budget->soft_ms;
+    s->aborted = 0;
+    float alpha = -BRS_INF, score[8];
+    int bi = 0;
+    for (int i = 0; i < n; i++) {
+      int dv = b->cells[mv[i].y * b->width + mv[i].x];
+      board_apply_move(b, self_id, mv[i]);
+      score[i] = brs_min(s, b, depth - 1, 1, alpha, BRS_INF);
+      board_undo_move(b, self_id, fx, fy, dv);
+      if (s->aborted)
+        break;
+      if (score[i] > alpha) {
+        alpha = score[i];
+        bi = i;
+      }
+    }
+    if (s->aborted)
+      break;
+    best = mv[bi];
+    s->depth_done = depth;
+    // Principal move first next iteration, the rest keep their order
+    for (int i = bi; i > 0; i--) {
+      CenteMove t = mv[i];
+      mv[i] = mv[i - 1];
+      mv[i - 1] = t;
+    }
+    // Every move is a proven loss (dead scores sit just above BRS_DEAD);
+    // wins are never proven, so any live score keeps deepening
+    if (alpha < BRS_DEAD + 0.5f)
+      break;
+  }
+  return best;
+}
@@ -0,0 +1,342 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include "include/cente_convolve.h"
+#include <pthread.h>
+#include <complex.h>
+#include <math.h>
+#include <string.h>
+#ifdef DEBUG
+#include <stdio.h>
+#include <stdlib.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CENTE_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define CENTE_NEON 1
+#include <arm_neon.h>
+#endif
+
+// ya[i] += k * xa[i]; yb[i] += k * xb[i] for i < n
+typedef void (*axpy2_fn)(float *ya, float *yb, const float *xa,
+                         const float *xb, float k, int n);
+
+static void axpy2_scalar(float *ya, float *yb, const float *xa,
+                         const float *xb, float k, int n) {
+  for (int i = 0; i < n; i++) {
+    ya[i] += k * xa[i];
+    yb[i] += k * xb[i];
+  }
+}
+
+// Single-map variant: y[i] += k * x[i]
+typedef void (*axpy_fn)(float *y, const float *x, float k, int n);
+
+static void axpy_scalar(float *y, const float *x, float k, int n) {
+  for (int i = 0; i < n; i++)
+    y[i] += k * x[i];
+}
+
+#ifdef CENTE_X86
+static void axpy2_sse2(float *ya, float *yb, const float *xa, const float *xb,
+                       float k, int n) {
+  __m128 kv = _mm_set1_ps(k);
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm_storeu_ps(ya + i, _mm_add_ps(_mm_loadu_ps(ya + i),
+                                     _mm_mul_ps(kv, _mm_loadu_ps(xa + i))));
+    _mm_storeu_ps(yb + i, _mm_add_ps(_mm_loadu_ps(yb + i),
+                                     _mm_mul_ps(kv, _mm_loadu_ps(xb + i))));
+  }
+  axpy2_scalar(ya + i, yb + i, xa + i, xb + i, k, n - i);
+}
+
+static void axpy_sse2(float *y, const float *x, float k, int n) {
+  __m128 kv = _mm_set1_ps(k);
+  int i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i),
+                                    _mm_mul_ps(kv, _mm_loadu_ps(x + i))));
+  axpy_scalar(y + i, x + i, k, n - i);
+}
+
+__attribute__((target("avx2,fma"))) static void
+axpy2_avx2(float *ya, float *yb, const float *xa, const float *xb, float k,
+           int n) {
+  __m256 kv = _mm256_set1_ps(k);
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_ps(ya + i, _mm256_fmadd_ps(kv, _mm256_loadu_ps(xa + i),
+                                             _mm256_loadu_ps(ya + i)));
+    _mm256_storeu_ps(yb + i, _mm256_fmadd_ps(kv, _mm256_loadu_ps(xb + i),
+                                             _mm256_loadu_ps(yb + i)));
+  }
+  axpy2_scalar(ya + i, yb + i, xa + i, xb + i, k, n - i);
+}
+
+__attribute__((target("avx2,fma"))) static void
+axpy_avx2(float *y, const float *x, float k, int n) {
+  __m256 kv = _mm256_set1_ps(k);
+  int i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm256_storeu_ps(y + i, _mm256_fmadd_ps(kv, _mm256_loadu_ps(x + i),
+                                            _mm256_loadu_ps(y + i)));
+  axpy_scalar(y + i, x + i, k, n - i);
+}
+#endif
+
+#ifdef CENTE_NEON
+static void axpy2_neon(float *ya, float *yb, const float *xa, const float *xb,
+                       float k, int n) {
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    vst1q_f32(ya + i, vfmaq_n_f32(vld1q_f32(ya + i), vld1q_f32(xa + i), k));
+    vst1q_f32(yb + i, vfmaq_n_f32(vld1q_f32(yb + i), vld1q_f32(xb + i), k));
+  }
+  axpy2_scalar(ya + i, yb + i, xa + i, xb + i, k, n - i);
+}
+
+static void axpy_neon(float *y, const float *x, float k, int n) {
+  int i = 0;
+  for (; i + 4 <= n; i += 4)
+    vst1q_f32(y + i, vfmaq_n_f32(vld1q_f32(y + i), vld1q_f32(x + i), k));
+  axpy_scalar(y + i, x + i, k, n - i);
+}
+#endif
+
+static axpy2_fn g_axpy2 = axpy2_scalar;
+static axpy_fn g_axpy = axpy_scalar;
+static const char *g_backend = "scalar";
+static pthread_once_t g_once = PTHREAD_ONCE_INIT;
+
+static void pick_backend(void) {
+#ifdef CENTE_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    g_axpy2 = axpy2_avx2;
+    g_axpy = axpy_avx2;
+    g_backend = "avx2";
+  } else if (__builtin_cpu_supports("sse2")) {
+    g_axpy2 = axpy2_sse2;
+    g_axpy = axpy_sse2;
+    g_backend = "sse2";
+  }
+#elif defined(CENTE_NEON)
+  g_axpy2 = axpy2_neon;
+  g_axpy = axpy_neon;
+  g_backend = "neon";
+#endif
+}
+
+const char *convolve_backend(void) {
+  pthread_once(&g_once, pick_backend);
+  return g_backend;
+}
+
+size_t convolve_scratch_floats(int w, int h, int r) {
+  // Two padded planes and two planes with an r-row apron
+  size_t s = (size_t)w + 2 * (size_t)r;
+  return 2 * s * ((size_t)h + ((size_t)h + 2 * (size_t)r));
+}
+
+void convolve_reference(const float *src, float *tmp, float *dst, int w, int h,
+                        const float *k, int r) {
+  // Horizontal
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      float s = 0.0f;
+      for (int i = -r; i <= r; i++) {
+        int xx = x + i;
+        if (xx < 0)
+          xx = 0;
+        if (xx >= w)
+          xx = w - 1;
+        s += src[y * w + xx] * k[i + r];
+      }
+      tmp[y * w + x] = s;
+    }
+  }
+  // Vertical
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      float s = 0.0f;
+      for (int i = -r; i <= r; i++) {
+        int yy = y + i;
+        if (yy < 0)
+          yy = 0;
+        if (yy >= h)
+          yy = h - 1;
+        s += tmp[yy * w + x] * k[i + r];
+      }
+      dst[y * w + x] = s;
+    }
+  }
+}
+
+// Copies row into pad[0 .. w+2r) with r replicated cells on each side
+static void pad_row(float *pad, const float *row, int w, int r) {
+  for (int i = 0; i < r; i++) {
+    pad[i] = row[0];
+    pad[r + w + i] = row[w - 1];
+  }
+  memcpy(pad + r, row, (size_t)w * sizeof(float));
+}
+
+#ifdef DEBUG
+static void check_against_reference(const float *src, const float *dst, int w,
+                                    int h, const float *k, int r) {
+  size_t n = (size_t)w * (size_t)h;
+  float *tmp = (float *)malloc(n * sizeof(float));
+  float *ref = (float *)malloc(n * sizeof(float));
+  if (tmp && ref) {
+    convolve_reference(src, tmp, ref, w, h, k, r);
+    float peak = 0.0f, err = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+      if (fabsf(src[i]) > peak)
+        peak = fabsf(src[i]);
+      if (fabsf(dst[i] - ref[i]) > err)
+        err = fabsf(dst[i] - ref[i]);
+    }
+    if (err > CENTE_CONVOLVE_TOLERANCE * (peak > 1.0f ? peak : 1.0f))
+      fprintf(stderr, "convolve(%s): error %g over tolerance\n",
+              convolve_backend(), (double)err);
+  }
+  free(tmp);
+  free(ref);
+}
+#endif
+
+// Each pass runs as 2r+1 axpys over a whole border-padded plane (row stride
+// w + 2r) instead of one per (row, tap), so the SIMD loops see a few long
+// runs rather than many runs of w floats. Summation order per cell matches
+// convolve_reference.
+void convolve_separable2(const float *src_a, const float *src_b, float *dst_a,
+                         float *dst_b, int w, int h, const float *k, int r,
+                         float *scratch) {
+  pthread_once(&g_once, pick_backend);
+  axpy2_fn axpy2 = g_axpy2;
+  const int s = w + 2 * r;
+  size_t plane = (size_t)h * s, tall = (size_t)(h + 2 * r) * s;
+  float *pa = scratch, *pb = pa + plane; // padded rows, later the output
+  float *va = pb + plane, *vb = va + tall; // horizontal result, r rows apron
+
+  for (int y = 0; y < h; y++) {
+    pad_row(pa + (size_t)y * s, src_a + (size_t)y * w, w, r);
+    pad_row(pb + (size_t)y * s, src_b + (size_t)y * w, w, r);
+  }
+  // Horizontal: cell (x, y) of the result lands at row r + y, column x; the
+  // last 2r columns of each row are junk the vertical pass carries along
+  size_t len = plane - 2 * (size_t)r;
+  float *ha = va + (size_t)r * s, *hb = vb + (size_t)r * s;
+  memset(ha, 0, len * sizeof(float));
+  memset(hb, 0, len * sizeof(float));
+  for (int i = 0; i <= 2 * r; i++)
+    axpy2(ha, hb, pa + i, pb + i, k[i], (int)len);
+  for (int i = 0; i < r; i++) {
+    memcpy(va + (size_t)i * s, ha, (size_t)w * sizeof(float));
+    memcpy(vb + (size_t)i * s, hb, (size_t)w * sizeof(float));
+    memcpy(ha + (size_t)(h + i) * s, ha + (size_t)(h - 1) * s,
+           (size_t)w * sizeof(float));
+    memcpy(hb + (size_t)(h + i) * s, hb + (size_t)(h - 1) * s,
+           (size_t)w * sizeof(float));
+  }
+
+  // Vertical: tap i reads the apron plane shifted down by i rows
+  memset(pa, 0, 2 * plane * sizeof(float));
+  for (int i = 0; i <= 2 * r; i++)
+    axpy2(pa, pb, va + (size_t)i * s, vb + (size_t)i * s, k[i], (int)plane);
+  for (int y = 0; y < h; y++) {
+    memcpy(dst_a + (size_t)y * w, pa + (size_t)y * s, (size_t)w * sizeof(float));
+    memcpy(dst_b + (size_t)y * w, pb + (size_t)y * s, (size_t)w * sizeof(float));
+  }
+#ifdef DEBUG
+  check_against_reference(src_a, dst_a, w, h, k, r);
+  check_against_reference(src_b, dst_b, w, h, k, r);
+#endif
+}
+
+// 3rd order recursive Gaussian y[n] = B*x[n] + c1*y[n-1] + c2*y[n-2] +
+// c3*y[n-3], run forwards and then backwards.
+//
+// Young/van Vliet poles for sigma = 2 (van Vliet, Young & Verbeek 1998).
+// Other scales are reached by raising them to 1/q, with q chosen so the
+// forward+backward cascade has variance sigma^2. Unlike the 1995 polynomial
+// fit this keeps the shape for large sigma.
+static const double IIR_D1_RE = 1.40098, IIR_D1_IM = 1.00236;
+static const double IIR_D3 = 1.85132;
+
+static double iir_variance(double q) {
+  double complex d1 = cpow(IIR_D1_RE + IIR_D1_IM * I, 1.0 / q);
+  double d3 = pow(IIR_D3, 1.0 / q);
+  double complex v1 = 2.0 * d1 / ((d1 - 1.0) * (d1 - 1.0));
+  return 2.0 * creal(v1) + 2.0 * d3 / ((d3 - 1.0) * (d3 - 1.0));
+}
+
+void convolve_iir_setup(CenteIIR *f, float sigma) {
+  // Variance grows monotonically with q: bisect
+  double target = (double)sigma * (double)sigma;
+  double lo = 0.05, hi = sigma + 2.0;
+  while (iir_variance(hi) < target)
+    hi *= 2.0;
+  for (int it = 0; it < 60; it++) {
+    double mid = 0.5 * (lo + hi);
+    if (iir_variance(mid) < target)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  double q = 0.5 * (lo + hi);
+  double complex a1 = 1.0 / cpow(IIR_D1_RE + IIR_D1_IM * I, 1.0 / q);
+  double a3 = 1.0 / pow(IIR_D3, 1.0 / q);
+  double re = creal(a1), mag2 = creal(a1 * conj(a1));
+  f->c1 = 2.0 * re + a3;
+  f->c2 = -(mag2 + 2.0 * re * a3);
+  f->c3 = mag2 * a3;
+  f->B = 1.0 - (f->c1 + f->c2 + f->c3);
+  // Replicated samples past the end so the backward pass starts from steady
+  // state, matching the FIR kernel's 3 sigma reach
+  f->pad = (int)ceilf(3.0f * sigma) + 3;
+  f->sigma = sigma;
+}
+
+size_t convolve_iir_scratch(const CenteIIR *f, int len) {
+  return (size_t)len + (size_t)f->pad;
+}
+
+void convolve_iir_impulse(const CenteIIR *f, int len, int s, float *out,
+                          double *buf) {
+  int m = len + f->pad;
+  for (int i = 0; i < m; i++)
+    buf[i] = 0.0;
+  if (s == len - 1) {
+    for (int i = s; i < m; i++)
+      buf[i] = 1.0;
+  } else {
+    buf[s] = 1.0;
+  }
+  // An impulse on cell 0 is replicated to the left: steady state of 1
+  double w1 = buf[0], w2 = buf[0], w3 = buf[0];
+  for (int i = 0; i < m; i++) {
+    double v = f->B * buf[i] + f->c1 * w1 + f->c2 * w2 + f->c3 * w3;
+    buf[i] = v;
+    w3 = w2;
+    w2 = w1;
+    w1 = v;
+  }
+  double y1 = buf[m - 1], y2 = y1, y3 = y1;
+  for (int i = m - 1; i >= 0; i--) {
+    double v = f->B * buf[i] + f->c1 * y1 + f->c2 * y2 + f->c3 * y3;
+    buf[i] = v;
+    y3 = y2;
+    y2 = y1;
+    y1 = v;
+  }
+  for (int i = 0; i < len; i++)
+    out[i] = (float)buf[i];
+}
+
+void convolve_axpy(float *y, const float *x, float k, int n) {
+  pthread_once(&g_once, pick_backend);
+  g_axpy(y, x, k, n);
+}
@@ -0,0 +1,299 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include "include/cente_endgame.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if CENTE_ENDGAME_EXACT > 64
+#error "CENTE_ENDGAME_EXACT must fit in a 64-bit mask"
+#endif
+
+#define MEMO_BITS 16
+
+typedef struct {
+  uint64_t vis;
+  int cur; // -1 marks an empty slot
+} MemoEntry;
+
+struct CenteEndgame {
+  int width, height;
+  unsigned *stamp; // per cell: == gen when in the current region
+  unsigned gen;
+  int *queue;      // region cells in BFS order
+  int qlen;
+
+  // Exact solver, over region cells renumbered 0..k-1 (k is the head)
+  int k;
+  uint64_t adj[CENTE_ENDGAME_EXACT + 1];
+  int val[CENTE_ENDGAME_EXACT];
+  int path[CENTE_ENDGAME_EXACT + 1];
+  int best_path[CENTE_ENDGAME_EXACT + 1];
+  int best_len;
+  int best_value;
+  long nodes;
+  MemoEntry *memo;
+
+  // Tour being followed: plan[0] is the head it started from
+  int *plan;
+  int plan_len;
+  int plan_pos;
+};
+
+static const int DX[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+static const int DY[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+
+CenteEndgame *endgame_create(int width, int height) {
+  CenteEndgame *eg = (CenteEndgame *)calloc(1, sizeof(CenteEndgame));
+  if (!eg)
+    return NULL;
+  size_t n = (size_t)width * (size_t)height;
+  eg->width = width;
+  eg->height = height;
+  eg->stamp = (unsigned *)calloc(n, sizeof(unsigned));
+  eg->queue = (int *)malloc(n * sizeof(int));
+  eg->plan = (int *)malloc((n + 1) * sizeof(int));
+  eg->memo = (MemoEntry *)malloc(((size_t)1 << MEMO_BITS) * sizeof(MemoEntry));
+  if (!eg->stamp || !eg->queue || !eg->plan || !eg->memo) {
+    endgame_destroy(eg);
+    return NULL;
+  }
+  return eg;
+}
+
+void endgame_destroy(CenteEndgame *eg) {
+  if (!eg)
+    return;
+  free(eg->stamp);
+  free(eg->queue);
+  free(eg->plan);
+  free(eg->memo);
+  free(eg);
+}
+
+static int in_region(const CenteEndgame *eg, int x, int y) {
+  return x >= 0 && y >= 0 && x < eg->width && y < eg->height &&
+         eg->stamp[y * eg->width + x] == eg->gen;
+}
+
+void endgame_region(CenteEndgame *eg, const Board *b, int self_id,
+                    CenteRegion *out) {
+  int w = eg->width, h = eg->height;
+  if (++eg->gen == 0) {
+    memset(eg->stamp, 0, (size_t)w * (size_t)h * sizeof(unsigned));
+    eg->gen = 1;
+  }
+  out->size = 0;
+  out->value = 0;
+  eg->qlen = 0;
+  int hx = b->head_x[self_id], hy = b->head_y[self_id];
+  int head = hy * w + hx;
+  for (int qi = -1; qi < eg->qlen; qi++) {
+    int c = qi < 0 ? head : eg->queue[qi];
+    int cx = c % w, cy = c / w;
+    for (int d = 0; d < 8; d++) {
+      int x = cx + DX[d], y = cy + DY[d];
+      if (x < 0 || y < 0 || x >= w || y >= h)
+        continue;
+      int i = y * w + x;
+      if (b->cells[i] <= 0 || eg->stamp[i] == eg->gen)
+        continue;
+      eg->stamp[i] = eg->gen;
+      eg->queue[eg->qlen++] = i;
+      out->value += b->cells[i];
+    }
+  }
+  out->size = eg->qlen;
+  out->isolated = 1;
+  for (int p = 0; p < b->num_players && out->isolated; p++) {
+    if (p == self_id || b->blocked[p])
+      continue;
+    for (int d = 0; d < 8; d++)
+      if (in_region(eg, b->head_x[p] + DX[d], b->head_y[p] + DY[d])) {
+        out->isolated = 0;
+        break;
+      }
+  }
+}
+
+// Region cells 8-adjacent to cell c
+static int onward(const CenteEndgame *eg, int c) {
+  int cx = c % eg->width, cy = c / eg->width, n = 0;
+  for (int d = 0; d < 8; d++)
+    n += in_region(eg, cx + DX[d], cy + DY[d]);
+  return n;
+}
+
+// Warnsdorff tour: step to the neighbour with the fewest onward exits,
+// breaking ties by value. Visited cells leave the region while the tour is
+// built and are put back afterwards.
+static void greedy_tour(CenteEndgame *eg, const Board *b, int head) {
+  eg->plan[0] = head;
+  eg->plan_len = 1;
+  int c = head;
+  for (;;) {
+    int cx = c % eg->width, cy = c / eg->width;
+    int best = -1, best_deg = 9, best_val = 0;
+    for (int d = 0; d < 8; d++) {
+      int x = cx + DX[d], y = cy + DY[d];
+      if (!in_region(eg, x, y))
+        continue;
+      int i = y * eg->width + x;
+      eg->stamp[i] = 0;
+      int deg = onward(eg, i);
+      eg->stamp[i] = eg->gen;
+      if (deg < best_deg || (deg == best_deg && b->cells[i] > best_val)) {
+        best = i;
+        best_deg = deg;
+        best_val = b->cells[i];
+      }
+    }
+    if (best < 0)
+      break;
+    eg->stamp[best] = 0;
+    eg->plan[eg->plan_len++] = best;
+    c = best;
+  }
+  for (int i = 1; i < eg->plan_len; i++)
+    eg->stamp[eg->plan[i]] = eg->gen;
+}
+
+// Value of the unvisited cells reachable from `from`: an upper bound on what
+// the rest of the tour can collect
+static int reach_value(const CenteEndgame *eg, uint64_t from, uint64_t vis) {
+  uint64_t reach = from, frontier = from;
+  while (frontier) {
+    uint64_t next = 0;
+    for (uint64_t f = frontier; f; f &= f - 1)
+      next |= eg->adj[__builtin_ctzll(f)];
+    next &= ~vis & ~reach;
+    reach |= next;
+    frontier = next;
+  }
+  int v = 0;
+  for (; reach; reach &= reach - 1)
+    v += eg->val[__builtin_ctzll(reach)];
+  return v;
+}
+
+// Returns 1 if (vis, cur) was searched before; the tour value is a function
+// of vis, so a second visit cannot do better
+static int memo_seen(CenteEndgame *eg, uint64_t vis, int cur) {
+  uint64_t hsh = (vis ^ ((uint64_t)cur * 0x9e3779b97f4a7c15ULL)) *
+                 0xbf58476d1ce4e5b9ULL;
+  MemoEntry *m = &eg->memo[hsh >> (64 - MEMO_BITS)];
+  if (m->cur == cur && m->vis == vis)
+    return 1;
+  m->vis = vis;
+  m->cur = cur;
+  return 0;
+}
+
+static void dfs(CenteEndgame *eg, uint64_t vis, int cur, int gained,
+                int depth) {
+  if (eg->nodes++ >= CENTE_ENDGAME_NODES)
+    return;
+  eg->path[depth] = cur;
+  if (gained > eg->best_value ||
+      (gained == eg->best_value && depth < eg->best_len)) {
+    eg->best_value = gained;
+    eg->best_len = depth;
+    memcpy(eg->best_path, eg->path, (size_t)(depth + 1) * sizeof(int));
+  }
+  uint64_t next = eg->adj[cur] & ~vis;
+  if (!next || gained + reach_value(eg, next, vis) <= eg->best_value)
+    return;
+  if (depth > 0 && memo_seen(eg, vis, cur))
+    return;
+  // Fewest onward exits first, as in the greedy tour
+  int order[8], deg[8], n = 0;
+  for (uint64_t f = next; f; f &= f - 1) {
+    int c = __builtin_ctzll(f);
+    int dg = __builtin_popcountll(eg->adj[c] & ~vis & ~(1ULL << c));
+    int j = n++;
+    for (; j > 0 && deg[j - 1] > dg; j--) {
+      order[j] = order[j - 1];
+      deg[j] = deg[j - 1];
+    }
+    order[j] = c;
+    deg[j] = dg;
+  }
+  for (int i = 0; i < n; i++) {
+    int c = order[i];
+    dfs(eg, vis | (1ULL << c), c, gained + eg->val[c], depth + 1);
+  }
+}
+
+// Exact max-value tour over the current region (size <= CENTE_ENDGAME_EXACT)
+static void exact_tour(CenteEndgame *eg, const Board *b, int head) {
+  int w = eg->width, k = eg->qlen;
+  eg->k = k;
+  // BFS order gives local indices; the head is k
+  int local[CENTE_ENDGAME_EXACT + 1];
+  for (int i = 0; i < k; i++) {
+    local[i] = eg->queue[i];
+    eg->val[i] = b->cells[local[i]];
+  }
+  local[k] = head;
+  for (int i = 0; i <= k; i++) {
+    eg->adj[i] = 0;
+    int cx = local[i] % w, cy = local[i] / w;
+    for (int j = 0; j < k; j++) {
+      int dx = local[j] % w - cx, dy = local[j] / w - cy;
+      if (j != i && dx >= -1 && dx <= 1 && dy >= -1 && dy <= 1)
+        eg->adj[i] |= 1ULL << j;
+    }
+  }
+  // The greedy tour is the bound to beat
+  greedy_tour(eg, b, head);
+  eg->best_value = 0;
+  for (int i = 1; i < eg->plan_len; i++)
+    eg->best_value += b->cells[eg->plan[i]];
+  eg->best_len = eg->plan_len - 1;
+  eg->best_path[0] = k;
+  for (size_t i = 0; i < ((size_t)1 << MEMO_BITS); i++)
+    eg->memo[i].cur = -1;
+  eg->nodes = 0;
+  int greedy_value = eg->best_value, greedy_len = eg->best_len;
+  dfs(eg, 0, k, 0, 0);
+  if (eg->best_value == greedy_value && eg->best_len == greedy_len)
+    return; // the greedy plan already holds an optimal tour
+  eg->plan_len = eg->best_len + 1;
+  for (int i = 0; i < eg->plan_len; i++)
+    eg->plan[i] = local[eg->best_path[i]];
+}
+
+int endgame_move(CenteEndgame *eg, const Board *b, int self_id,
+                 CenteMove *out) {
+  CenteRegion r;
+  endgame_region(eg, b, self_id, &r);
+  if (r.size == 0 || !r.isolated) {
+    eg->plan_len = 0;
+    return 0;
+  }
+  int w = eg->width;
+  int head = b->head_y[self_id] * w + b->head_x[self_id];
+  // Keep following the tour while we are where it expects us; the region
+  // cannot change under us once it is isolated
+  int follow = eg->plan_pos + 1 < eg->plan_len &&
+               eg->plan[eg->plan_pos] == head &&
+               b->cells[eg->plan[eg->plan_pos + 1]] > 0;
+  if (!follow) {
+    if (r.size <= CENTE_ENDGAME_EXACT)
+      exact_tour(eg, b, head);
+    else
+      greedy_tour(eg, b, head);
+    eg->plan_pos = 0;
+    if (eg->plan_len < 2)
+      return 0;
+  }
+  int next = eg->plan[++eg->plan_pos];
+  out->x = next % w;
+  out->y = next / w;
+  return 1;
+}
+
+void endgame_reset(CenteEndgame *eg) {
+  eg->plan_len = 0;
+  eg->plan_pos = 0;
+}
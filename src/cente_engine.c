@@ -0,0 +1,267 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include "include/cente_engine.h"
+#include "include/cente_autotune.h"
+#include "include/cente_eval.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+CenteEngine *engine_create(int width, int height, int num_players,
+                           int self_id) {
+  CenteEngine *e = (CenteEngine *)calloc(1, sizeof(CenteEngine));
+  if (!e)
+    return NULL;
+  e->width = width;
+  e->height = height;
+  e->self_id = self_id;
+  size_t n = (size_t)width * (size_t)height;
+  int *zero = (int *)calloc(n, sizeof(int));
+  unsigned short hz[CENTE_MAX_PLAYERS] = {0};
+  unsigned char bz[CENTE_MAX_PLAYERS] = {0};
+  unsigned int sz[CENTE_MAX_PLAYERS] = {0};
+  if (zero)
+    e->board = board_create_from_shared(width, height, num_players, hz, hz,
+                                        bz, sz, zero, self_id);
+  free(zero);
+  e->inf_base = influence_create(width, height);
+  e->inf = influence_create(width, height);
+  e->tree = mcts_tree_create(width, height, CENTE_MAX_NODES);
+  e->endgame = endgame_create(width, height);
+  e->brs = brs_create(width, height);
+  if (!e->board || !e->inf_base || !e->inf || !e->tree || !e->endgame ||
+      !e->brs) {
+    engine_destroy(e);
+    return NULL;
+  }
+  turn_clock_init(&e->clock);
+  cente_params_defaults(&e->params);
+  const char *params = getenv("CENTE_PARAMS");
+  if (params && *params) {
+    // A failed load leaves its copy partly updated: keep the defaults whole
+    CenteParams loaded = e->params;
+    if (cente_params_load(params, &loaded) == 0)
+      e->params = loaded;
+    else
+      fprintf(stderr, "CENTE_PARAMS: ignoring bad parameter file %s\n", params);
+  }
+  e->book = book_open_default(width, height, num_players);
+  e->search_mode = CENTE_SEARCH_MODE;
+  const char *mode = getenv("CENTE_SEARCH");
+  if (mode) {
+    if (strcmp(mode, "mcts") == 0)
+      e->search_mode = CENTE_SEARCH_MCTS;
+    else if (strcmp(mode, "brs") == 0)
+      e->search_mode = CENTE_SEARCH_BRS;
+    else if (strcmp(mode, "auto") == 0)
+      e->search_mode = CENTE_SEARCH_AUTO;
+  }
+#if CENTE_PONDER
+  e->has_ponder = ponder_init(&e->ponder, width, height) == 0;
+#endif
+  return e;
+}
+
+void engine_destroy(CenteEngine *e) {
+  if (!e)
+    return;
+  if (e->has_ponder)
+    ponder_destroy(&e->ponder);
+  book_close(e->book);
+  brs_destroy(e->brs);
+  endgame_destroy(e->endgame);
+  mcts_tree_destroy(e->tree);
+  influence_destroy(e->inf);
+  influence_destroy(e->inf_base);
+  board_destroy(e->board);
+  free(e);
+}
+
+void engine_reset(CenteEngine *e) {
+  if (e->has_ponder)
+    ponder_cancel(&e->ponder);
+  mcts_tree_clear(e->tree);
+  endgame_reset(e->endgame);
+  turn_clock_init(&e->clock);
+  e->tuned_sigma = 0.0f;
+  e->synced = 0;
+}
+
+static int is_step(int x0, int y0, int x1, int y1) {
+  int dx = x1 - x0, dy = y1 - y0;
+  return (dx || dy) && dx >= -1 && dx <= 1 && dy >= -1 && dy <= 1;
+}
+
+int engine_sync(CenteEngine *e, int num_players, const unsigned short *hx,
+                const unsigned short *hy, const unsigned char *blocked,
+                const unsigned int *score, const unsigned int *valid_moves,
+                const int *cells) {
+  Board *b = e->board;
+  int full = !e->synced || num_players != b->num_players;
+  for (int p = 0; p < num_players && !full; p++) {
+    unsigned int steps = valid_moves[p] - e->valid_seen[p];
+    if (steps > 1 ||
+        (steps == 1 && !is_step(b->head_x[p], b->head_y[p], hx[p], hy[p])) ||
+        (steps == 0 && (b->head_x[p] != hx[p] || b->head_y[p] != hy[p])))
+      full = 1;
+  }
+
+  int moved = 0;
+  if (full) {
+    memcpy(b->cells, cells,
+           (size_t)e->width * (size_t)e->height * sizeof(int));
+    b->num_players = num_players;
+    for (int p = 0; p < num_players; p++)
+      moved += b->head_x[p] != hx[p] || b->head_y[p] != hy[p];
+  } else {
+    // The master leaves -p on both the old and the new head cell
+    for (int p = 0; p < num_players; p++) {
+      if (valid_moves[p] == e->valid_seen[p])
+        continue;
+      board_occupy(b, hy[p] * e->width + hx[p], -p);
+      moved++;
+    }
+  }
+  for (int p = 0; p < num_players; p++) {
+    board_set_head(b, p, hx[p], hy[p]);
+    b->blocked[p] = blocked[p];
+    b->score[p] = score[p];
+    e->valid_seen[p] = valid_moves[p];
+  }
+  if (full)
+    board_stats_rebuild(b);
+  b->current_player = e->self_id;
+  e->synced = 1;
+  return moved;
+}
+
+// Best-reply search pays off once a rival head is close enough to fight over
+// the same cells; further out MCTS sees more of the board
+static int use_brs(const CenteEngine *e, const Board *b, int player_id) {
+  if (e->search_mode != CENTE_SEARCH_AUTO)
+    return e->search_mode == CENTE_SEARCH_BRS;
+  for (int p = 0; p < b->num_players; p++) {
+    if (p == player_id || b->blocked[p])
+      continue;
+    int dx = abs(b->head_x[p] - b->head_x[player_id]);
+    int dy = abs(b->head_y[p] - b->head_y[player_id]);
+    if ((dx > dy ? dx : dy) <= CENTE_BRS_NEAR)
+      return 1;
+  }
+  return 0;
+}
+
+static double ms_since(unsigned long long t0_us) {
+  return (double)(cente_now_us() - t0_us) / 1000.0;
+}
+
+CenteMove engine_choose(CenteEngine *e, CenteBudget budget, int pondered_ms) {
+  Board *b = e->board;
+  InfluenceMap *inf = e->inf;
+  int player_id = e->self_id;
+  CenteTurnStats *st = &e->stats;
+  unsigned long long t_start = cente_now_us(), t0;
+  memset(st, 0, sizeof(*st));
+  st->self_id = player_id;
+
+  // Book moves are played instantly; the search starts once we leave it
+  CenteMove mv;
+  st->mode = CENTE_TURN_BOOK;
+  if (book_probe(e->book, b, player_id, &mv)) {
+    st->total_ms = ms_since(t_start);
+    return mv;
+  }
+  // Alone in our region: tour it instead of searching
+  st->mode = CENTE_TURN_ENDGAME;
+  if (endgame_move(e->endgame, b, player_id, &mv)) {
+    st->total_ms = ms_since(t_start);
+    return mv;
+  }
+
+  cente_size_params base = cente_params_for_size(&e->params, e->width,
+                                                 e->height);
+  base.budget_ms = budget.soft_ms;
+  // Last turn's tuned sigma is the best guess for this one: build both maps
+  // from a single pass over the heads
+  t0 = cente_now_us();
+  if (e->tuned_sigma > 0.0f && fabsf(e->tuned_sigma - base.sigma) > 1e-6f) {
+    float sig[2] = {base.sigma, e->tuned_sigma};
+    InfluenceMap *maps[2] = {e->inf_base, e->inf};
+    compute_influence_multi(b, player_id, sig, maps, 2);
+    st->influence_builds = 2;
+  } else {
+    compute_influence_update(b, player_id, base.sigma, e->inf_base);
+    st->influence_builds = 1;
+  }
+  st->influence_ms = ms_since(t0);
+  cente_phase ph;
+  cente_weights wts;
+  t0 = cente_now_us();
+  phase_detect(b, e->inf_base, &e->params, &ph, &wts);
+  st->phase_ms = ms_since(t0);
+
+  cente_size_params tuned;
+  t0 = cente_now_us();
+  float tempo = cente_autotune(b, player_id, e->inf_base, ph, &base, &tuned);
+  (void)tempo;
+  st->autotune_ms = ms_since(t0);
+  // Quantised so the tuned map stays incrementally updatable between turns
+  tuned.sigma = roundf(tuned.sigma * 8.0f) / 8.0f;
+  if (fabsf(tuned.sigma - base.sigma) > 1e-6f) {
+    // Influence with the tuned sigma (a no-op when the guess was right)
+    if (tuned.sigma != e->tuned_sigma) {
+      t0 = cente_now_us();
+      compute_influence_update(b, player_id, tuned.sigma, inf);
+      st->influence_ms += ms_since(t0);
+      st->influence_builds++;
+    }
+  } else {
+    inf = e->inf_base;
+  }
+  e->tuned_sigma = tuned.sigma;
+  // Autotune may grant a burst on critical turns, within the hard limit
+  budget.soft_ms = tuned.budget_ms < budget.hard_ms ? tuned.budget_ms
+                                                    : budget.hard_ms;
+  if (use_brs(e, b, player_id)) {
+    if (budget.soft_ms < 2)
+      budget.soft_ms = 2;
+    st->mode = CENTE_TURN_BRS;
+    st->soft_ms = budget.soft_ms;
+    st->hard_ms = budget.hard_ms;
+    t0 = cente_now_us();
+    mv = brs_search(e->brs, b, player_id, inf, &wts, &budget);
+    st->search_ms = ms_since(t0);
+    st->iterations = brs_last_nodes(e->brs);
+    st->max_depth = brs_last_depth(e->brs);
+    st->total_ms = ms_since(t_start);
+    return mv;
+  }
+  // A matching pondered subtree already holds pondered_ms of search
+  if (mcts_tree_set_root(e->tree, b, player_id)) {
+    budget.soft_ms -= pondered_ms;
+    budget.hard_ms -= pondered_ms;
+    st->pondered_ms = pondered_ms;
+  }
+  if (budget.soft_ms < 2)
+    budget.soft_ms = 2;
+  if (budget.hard_ms < budget.soft_ms)
+    budget.hard_ms = budget.soft_ms;
+  st->mode = CENTE_TURN_MCTS;
+  st->soft_ms = budget.soft_ms;
+  st->hard_ms = budget.hard_ms;
+  t0 = cente_now_us();
+  mv = mcts_search(e->tree, b, player_id, inf, &wts, &tuned.mcts, &budget,
+                   NULL);
+  st->search_ms = ms_since(t0);
+  int iters;
+  mcts_last_stats(e->tree, &iters, &st->max_depth);
+  st->iterations = iters;
+  st->root_n = mcts_root_visits(e->tree, st->root_moves, st->root_visits,
+                                CENTE_MAX_CHILDREN);
+  if (e->has_ponder && board_is_legal(b, player_id, mv))
+    ponder_start(&e->ponder, e->tree, b, player_id, mv, tuned.sigma, &wts,
+                 &tuned.mcts);
+  st->total_ms = ms_since(t_start);
+  return mv;
+}
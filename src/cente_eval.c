@@ -1,105 +1,93 @@
 // This is a personal academic project. Dear PVS-Studio, please check it.
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 #include "include/cente_eval.h"
+#include "include/cente_kernels.h"
 #include <math.h>
+#include <stdlib.h>
 
 static float clamp01(float v) {
   return v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
 }
 
+// g_central[y*w + x] = centrality_score of (x,y)
+static float *g_central = NULL;
+static int g_cw = 0, g_ch = 0;
+
+static float centrality_at(int width, int height, int x, int y) {
+  float cx = (width - 1) * 0.5f;
+  float cy = (height - 1) * 0.5f;
+  float nx = (x - cx) / (cx + 1e-6f);
+  float ny = (y - cy) / (cy + 1e-6f);
+  float d = sqrtf(nx * nx + ny * ny);
+  float c = 1.0f - d;
+  if (c < 0.0f)
+    c = 0.0f;
+  if (c > 1.0f)
+    c = 1.0f;
+  return c;
+}
+
+void eval_init(int width, int height) {
+  if (g_central && g_cw == width && g_ch == height)
+    return;
+  free(g_central);
+  g_central = (float *)malloc((size_t)width * (size_t)height * sizeof(float));
+  if (!g_central) {
+    g_cw = g_ch = 0;
+    return;
+  }
+  g_cw = width;
+  g_ch = height;
+  for (int y = 0; y < height; y++)
+    for (int x = 0; x < width; x++)
+      g_central[y * width + x] = centrality_at(width, height, x, y);
+}
+
+// Centrality table for b, or NULL if eval_init was not called for its size
+static const float *central_table(const Board *b) {
+  return g_central && g_cw == b->width && g_ch == b->height ? g_central
+                                                            : NULL;
+}
+
 void phase_detect(const Board *b, const InfluenceMap *inf,
-                  cente_phase *phase_out, cente_weights *w_out) {
+                  const CenteParams *params, cente_phase *phase_out,
+                  cente_weights *w_out) {
   (void)inf;
   // Density: ratio of occupied cells
-  int bw = b->width, h = b->height;
-  int n = bw * h;
-  int occ = 0;
-  for (int i = 0; i < n; i++)
-    if (b->cells[i] <= 0)
-      occ++;
-  float density = (float)occ / (float)n;
+  float density = (float)b->stats.occupied / (float)(b->width * b->height);
   // Simple phase heuristic
   cente_phase ph = density < 0.25f
                        ? PHASE_OPENING
                        : (density < 0.70f ? PHASE_MIDGAME : PHASE_ENDGAME);
   *phase_out = ph;
-  cente_weights w;
-  if (ph == PHASE_OPENING) {
-    w.alpha = 0.25f;
-    w.beta = 0.35f;
-    w.gamma = 0.20f;
-    w.delta = 0.05f;
-    w.eps = 0.20f;
-    w.zeta = 0.10f;
-  } else if (ph == PHASE_MIDGAME) {
-    w.alpha = 0.30f;
-    w.beta = 0.25f;
-    w.gamma = 0.20f;
-    w.delta = 0.10f;
-    w.eps = 0.20f;
-    w.zeta = 0.15f;
-  } else {
-    w.alpha = 0.30f;
-    w.beta = 0.15f;
-    w.gamma = 0.10f;
-    w.delta = 0.25f;
-    w.eps = 0.10f;
-    w.zeta = 0.25f;
-  }
-  *w_out = w;
+  *w_out = params->phase[ph];
 }
 
 float centrality_score(const Board *b, CenteMove m) {
-  float cx = (b->width - 1) * 0.5f;
-  float cy = (b->height - 1) * 0.5f;
-  float nx = (m.x - cx) / (cx + 1e-6f);
-  float ny = (m.y - cy) / (cy + 1e-6f);
-  float d = sqrtf(nx * nx + ny * ny);
-  float c = 1.0f - d;
-  if (c < 0.0f)
-    c = 0.0f;
-  if (c > 1.0f)
-    c = 1.0f;
-  return c;
+  const float *cent = central_table(b);
+  return cent ? cent[m.y * b->width + m.x]
+              : centrality_at(b->width, b->height, m.x, m.y);
 }
 
 float mobility_score(const Board *b, int player_id) {
-  static const int dx[8] = {0, 1, 1, 1, 0, -1, -1, -1};
-  static const int dy[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
-  int x = b->head_x[player_id];
-  int y = b->head_y[player_id];
-  int legal = 0;
-  for (int d = 0; d < 8; d++) {
-    int nx = x + dx[d], ny = y + dy[d];
-    if (nx >= 0 && nx < b->width && ny >= 0 && ny < b->height) {
-      int c = b->cells[ny * b->width + nx];
-      int occ = c <= 0;
-      for (int j = 0; j < b->num_players && !occ; j++) {
-        if (j == player_id)
-          continue;
-        if (!b->blocked[j] && b->head_x[j] == (unsigned short)nx &&
-            b->head_y[j] == (unsigned short)ny)
-          occ = 1;
-      }
-      if (!occ)
-        legal++;
-    }
-  }
+  // Heads are occupied cells, so the free neighbours are the legal moves
+  int legal = b->stats.free_nbr[b->head_y[player_id] * b->width +
+                                b->head_x[player_id]];
   return clamp01((float)legal / 8.0f);
 }
 
 float stability_proxy(const Board *b, const InfluenceMap *inf, CenteMove m) {
   int i = m.y * b->width + m.x;
-  float support = inf->iyou[i];
-  float border = inf->grad[i];
+  float support = influence_you(inf, i);
+  float border = influence_grad(inf, i);
   float s = 0.7f * support + 0.3f * (1.0f - border);
   return clamp01(s);
 }
 
 float risk_proxy(const Board *b, const InfluenceMap *inf, CenteMove m) {
   int i = m.y * b->width + m.x;
-  float t = inf->t[i];
-  float g = inf->grad[i];
+  float t = influence_t(inf, i);
+  float g = influence_grad(inf, i);
   float risk = 0.6f * g + 0.4f * (t > 0.75f ? 1.0f : 0.0f);
   return clamp01(risk);
 }
@@ -122,9 +110,9 @@ static float claim_urgency(const Board *b, const InfluenceMap *inf,
   // High if cell has value and rival pressure/border high
   float val = cell_value_norm(b, m);
   int i = m.y * b->width + m.x;
-  float rival = inf->irival[i];
-  float grad = inf->grad[i];
-  float you = inf->iyou[i];
+  float rival = influence_rival(inf, i);
+  float grad = influence_grad(inf, i);
+  float you = influence_you(inf, i);
   float pressure = clamp01(0.6f * rival + 0.4f * grad - 0.3f * you + 0.5f);
   return clamp01(val * pressure);
 }
@@ -134,7 +122,7 @@ float tempo_score_1ply(const Board *b, int player_id, const InfluenceMap *inf,
   (void)player_id;
   // Approx: IM ~ our local value - opponent local best
   float our =
-      0.5f * centrality_score(b, m) + 0.5f * inf->t[m.y * b->width + m.x];
+      0.5f * centrality_score(b, m) + 0.5f * influence_t(inf, m.y * b->width + m.x);
   // Opponent best in neighborhood of our destination
   static const int dx[8] = {0, 1, 1, 1, 0, -1, -1, -1};
   static const int dy[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
@@ -144,7 +132,7 @@ float tempo_score_1ply(const Board *b, int player_id, const InfluenceMap *inf,
     if (nx < 0 || ny < 0 || nx >= b->width || ny >= b->height)
       continue;
     float v = 0.5f * (1.0f - centrality_score(b, (CenteMove){nx, ny})) +
-              0.5f * inf->t[ny * b->width + nx];
+              0.5f * influence_t(inf, ny * b->width + nx);
     if (v > opp_best)
       opp_best = v;
   }
@@ -158,7 +146,7 @@ float prior_cente(const Board *b, int player_id, const InfluenceMap *inf,
   float stab = stability_proxy(b, inf, m);
   float risk = risk_proxy(b, inf, m);
   float tempo = tempo_score_1ply(b, player_id, inf, m);
-  float tval = inf->t[m.y * b->width + m.x];
+  float tval = influence_t(inf, m.y * b->width + m.x);
   float claim = claim_urgency(b, inf, m);
   // Emphasize claiming valuable cells without abandoning cente principles
   float prior = 0.20f * c + 0.25f * tval + 0.15f * tempo + 0.10f * stab +
@@ -166,10 +154,136 @@ float prior_cente(const Board *b, int player_id, const InfluenceMap *inf,
   return clamp01(prior);
 }
 
+void prior_cente_batch(const Board *b, int player_id, const InfluenceMap *inf,
+                       const CenteMove *moves, int n, float *out) {
+  if (n > CENTE_EVAL_BATCH)
+    n = CENTE_EVAL_BATCH;
+  if (n <= 0)
+    return;
+  kernels_for(b->width, b->height)->prior_batch(b, player_id, inf, moves, n,
+                                                out);
+}
+
+CENTE_FORCE_INLINE void prior_batch_impl(const Board *b,
+                                         const InfluenceMap *inf,
+                                         const CenteMove *moves, int n,
+                                         float *out, const int w,
+                                         const int h) {
+  const float *cent = central_table(b);
+
+  // Opponent reply value 0.5*(1 - centrality) + 0.5*T over the candidates'
+  // bounding box grown by one cell: neighbouring candidates share cells, so
+  // each is computed once (25 cells for the 8 moves around a head)
+  int x0 = w, y0 = h, x1 = -1, y1 = -1;
+  for (int j = 0; j < n; j++) {
+    x0 = moves[j].x < x0 ? moves[j].x : x0;
+    x1 = moves[j].x > x1 ? moves[j].x : x1;
+    y0 = moves[j].y < y0 ? moves[j].y : y0;
+    y1 = moves[j].y > y1 ? moves[j].y : y1;
+  }
+  x0 = x0 > 0 ? x0 - 1 : 0;
+  y0 = y0 > 0 ? y0 - 1 : 0;
+  x1 = x1 < w - 1 ? x1 + 1 : w - 1;
+  y1 = y1 < h - 1 ? y1 + 1 : h - 1;
+  int bw = x1 - x0 + 1, bh = y1 - y0 + 1;
+  float box[CENTE_EVAL_BATCH * 4];
+  int use_box = bw * bh <= CENTE_EVAL_BATCH * 4;
+  if (use_box)
+    for (int y = y0; y <= y1; y++)
+      for (int x = x0; x <= x1; x++) {
+        int i = y * w + x;
+        float c = cent ? cent[i] : centrality_at(w, h, x, y);
+        box[(y - y0) * bw + (x - x0)] =
+            0.5f * (1.0f - c) + 0.5f * influence_t(inf, i);
+      }
+
+  // Structure of arrays: one row per feature, one column per candidate
+  float c[CENTE_EVAL_BATCH], t[CENTE_EVAL_BATCH], you[CENTE_EVAL_BATCH];
+  float rival[CENTE_EVAL_BATCH], grad[CENTE_EVAL_BATCH];
+  float val[CENTE_EVAL_BATCH], opp[CENTE_EVAL_BATCH];
+  for (int j = 0; j < n; j++) {
+    int x = moves[j].x, y = moves[j].y, i = y * w + x;
+    c[j] = cent ? cent[i] : centrality_at(w, h, x, y);
+    t[j] = influence_t(inf, i);
+    you[j] = influence_you(inf, i);
+    rival[j] = influence_rival(inf, i);
+    grad[j] = influence_grad(inf, i);
+    int v = b->cells[i];
+    val[j] = v <= 0 ? 0.0f : clamp01((float)v / 255.0f);
+    float best = 0.0f;
+    for (int ny = y - 1; ny <= y + 1; ny++)
+      for (int nx = x - 1; nx <= x + 1; nx++) {
+        if ((nx == x && ny == y) || nx < 0 || ny < 0 || nx >= w || ny >= h)
+          continue;
+        float o = use_box ? box[(ny - y0) * bw + (nx - x0)]
+                          : 0.5f * (1.0f - centrality_score(
+                                               b, (CenteMove){nx, ny})) +
+                                0.5f * influence_t(inf, ny * w + nx);
+        best = o > best ? o : best;
+      }
+    opp[j] = best;
+  }
+  for (int j = 0; j < n; j++) {
+    float stab = clamp01(0.7f * you[j] + 0.3f * (1.0f - grad[j]));
+    float risk = clamp01(0.6f * grad[j] + (t[j] > 0.75f ? 0.4f : 0.0f));
+    float our = 0.5f * c[j] + 0.5f * t[j];
+    float tempo = clamp01(0.5f + 0.5f * (our - opp[j]));
+    float pressure =
+        clamp01(0.6f * rival[j] + 0.4f * grad[j] - 0.3f * you[j] + 0.5f);
+    float claim = clamp01(val[j] * pressure);
+    float prior = 0.20f * c[j] + 0.25f * t[j] + 0.15f * tempo + 0.10f * stab +
+                  0.05f * (1.0f - risk) + 0.25f * claim;
+    out[j] = clamp01(prior);
+  }
+}
+
+#define PRIOR_BATCH_VARIANT(W, H, S)                                           \
+  void prior_cente_batch_##W##x##H(const Board *b, int player_id,              \
+                                   const InfluenceMap *inf,                    \
+                                   const CenteMove *moves, int n,              \
+                                   float *out) {                               \
+    (void)player_id;                                                           \
+    prior_batch_impl(b, inf, moves, n, out, W, H);                             \
+  }
+CENTE_KERNEL_SIZES(PRIOR_BATCH_VARIANT)
+
+void prior_cente_batch_generic(const Board *b, int player_id,
+                               const InfluenceMap *inf, const CenteMove *moves,
+                               int n, float *out) {
+  (void)player_id;
+  prior_batch_impl(b, inf, moves, n, out, b->width, b->height);
+}
+
+void prior_cente_order(const Board *b, const InfluenceMap *inf,
+                       CenteMove *moves, int n) {
+  float key[CENTE_EVAL_BATCH];
+  if (n > CENTE_EVAL_BATCH)
+    n = CENTE_EVAL_BATCH;
+  for (int j = 0; j < n; j++) {
+    int i = moves[j].y * b->width + moves[j].x;
+    int v = b->cells[i];
+    float val = v <= 0 ? 0.0f : clamp01((float)v / 255.0f);
+    key[j] = 0.20f * centrality_score(b, moves[j]) +
+             0.25f * influence_t(inf, i) + 0.125f * val;
+  }
+  // Insertion sort: n is at most the 8 neighbours
+  for (int j = 1; j < n; j++) {
+    float k = key[j];
+    CenteMove m = moves[j];
+    int i = j - 1;
+    for (; i >= 0 && key[i] < k; i--) {
+      key[i + 1] = key[i];
+      moves[i + 1] = moves[i];
+    }
+    key[i + 1] = k;
+    moves[i + 1] = m;
+  }
+}
+
 float value_eval(const Board *b, int player_id, const InfluenceMap *inf,
                  const cente_weights *w) {
   // Territory around our head
-  float t_head = inf->t[b->head_y[player_id] * b->width + b->head_x[player_id]];
+  float t_head = influence_t(inf, b->head_y[player_id] * b->width + b->head_x[player_id]);
   // Include current score ratio to value claiming points
   unsigned int sum_scores = 0;
   for (int p = 0; p < b->num_players; p++)
@@ -1,22 +1,21 @@
 // This is a personal academic project. Dear PVS-Studio, please check it.
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 #include "include/cente_influence.h"
+#include "include/cente_config.h"
+#include "include/cente_convolve.h"
+#include "include/cente_kernels.h"
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
-static void gaussian_kernel_1d(float sigma, float **out_kernel,
-                               int *out_radius) {
+static float *gaussian_kernel_1d(float sigma, int *out_radius) {
   int radius = (int)ceilf(3.0f * sigma);
   if (radius < 1)
     radius = 1;
   int size = 2 * radius + 1;
   float *k = (float *)malloc((size_t)size * sizeof(float));
-  if (!k) {
-    *out_kernel = NULL;
-    *out_radius = 0;
-    return;
-  }
+  if (!k)
+    return NULL;
   float sum = 0.0f;
   float inv2s2 = 1.0f / (2.0f * sigma * sigma);
   for (int i = -radius, j = 0; i <= radius; i++, j++) {
@@ -26,28 +25,76 @@ static void gaussian_kernel_1d(float sigma, float **out_kernel,
   }
   for (int j = 0; j < size; j++)
     k[j] /= sum;
-  *out_kernel = k;
   *out_radius = radius;
+  return k;
+}
+
+static float quantise_sigma(float sigma) {
+  float q = roundf(sigma * CENTE_SIGMA_QUANTUM) / CENTE_SIGMA_QUANTUM;
+  return q < 1.0f / CENTE_SIGMA_QUANTUM ? 1.0f / CENTE_SIGMA_QUANTUM : q;
 }
 
 InfluenceMap *influence_create(int width, int height) {
+  int compact = (long)width * (long)height >= CENTE_INF_COMPACT_CELLS;
+  const char *env = getenv("CENTE_INF_COMPACT");
+  if (env && *env)
+    compact = strcmp(env, "0") != 0;
+  return influence_create_storage(width, height, compact);
+}
+
+InfluenceMap *influence_create_storage(int width, int height, int compact) {
   InfluenceMap *m = (InfluenceMap *)calloc(1, sizeof(InfluenceMap));
   if (!m)
     return NULL;
   m->width = width;
   m->height = height;
   size_t n = (size_t)width * (size_t)height;
-  m->iyou = (float *)calloc(n, sizeof(float));
-  m->irival = (float *)calloc(n, sizeof(float));
-  m->t = (float *)calloc(n, sizeof(float));
-  m->grad = (float *)calloc(n, sizeof(float));
-  if (!m->iyou || !m->irival || !m->t || !m->grad) {
+  int ok;
+  if (compact) {
+    m->qyou = (uint16_t *)calloc(n, sizeof(uint16_t));
+    m->qrival = (uint16_t *)calloc(n, sizeof(uint16_t));
+    m->qt = (uint16_t *)calloc(n, sizeof(uint16_t));
+    m->qgrad = (uint16_t *)calloc(n, sizeof(uint16_t));
+    ok = m->qyou && m->qrival && m->qt && m->qgrad;
+  } else {
+    m->iyou = (float *)calloc(n, sizeof(float));
+    m->irival = (float *)calloc(n, sizeof(float));
+    m->t = (float *)calloc(n, sizeof(float));
+    m->grad = (float *)calloc(n, sizeof(float));
+    ok = m->iyou && m->irival && m->t && m->grad;
+  }
+  m->blocks_x = (width + CENTE_INF_BLOCK - 1) / CENTE_INF_BLOCK;
+  m->blocks_y = (height + CENTE_INF_BLOCK - 1) / CENTE_INF_BLOCK;
+  size_t nb = (size_t)INF_MAPS * (size_t)m->blocks_x * (size_t)m->blocks_y;
+  m->blk_lo = (float *)calloc(nb, sizeof(float));
+  m->blk_hi = (float *)calloc(nb, sizeof(float));
+  if (!ok || !m->blk_lo || !m->blk_hi) {
     influence_destroy(m);
     return NULL;
   }
+  for (int k = 0; k < INF_MAPS; k++) {
+    m->scale[k] = 1.0f;
+    m->qstep[k] = 1.0f;
+  }
+  m->blur = CENTE_BLUR_MODE;
+  const char *env = getenv("CENTE_BLUR");
+  if (env) {
+    if (strcmp(env, "fir") == 0)
+      m->blur = CENTE_BLUR_FIR;
+    else if (strcmp(env, "iir") == 0)
+      m->blur = CENTE_BLUR_IIR;
+    else if (strcmp(env, "auto") == 0)
+      m->blur = CENTE_BLUR_AUTO;
+  }
   return m;
 }
 
+void influence_set_blur(InfluenceMap *m, int mode) {
+  if (m->blur != mode)
+    m->valid = 0;
+  m->blur = mode;
+}
+
 void influence_destroy(InfluenceMap *m) {
   if (!m)
     return;
@@ -55,133 +102,512 @@ void influence_destroy(InfluenceMap *m) {
   free(m->irival);
   free(m->t);
   free(m->grad);
+  free(m->qyou);
+  free(m->qrival);
+  free(m->qt);
+  free(m->qgrad);
+  for (int i = 0; i < CENTE_KERNEL_CACHE; i++)
+    free(m->kcache[i].taps);
+  free(m->work);
+  free(m->blk_lo);
+  free(m->blk_hi);
   free(m);
 }
 
-static void convolve_separable(const float *src, float *tmp, float *dst, int w,
-                               int h, const float *k, int r) {
-  // Horizontal
-  for (int y = 0; y < h; y++) {
-    for (int x = 0; x < w; x++) {
-      float s = 0.0f;
-      for (int i = -r; i <= r; i++) {
-        int xx = x + i;
-        if (xx < 0)
-          xx = 0;
-        if (xx >= w)
-          xx = w - 1;
-        s += src[y * w + xx] * k[i + r];
-      }
-      tmp[y * w + x] = s;
-    }
-  }
-  // Vertical
-  for (int y = 0; y < h; y++) {
-    for (int x = 0; x < w; x++) {
-      float s = 0.0f;
-      for (int i = -r; i <= r; i++) {
-        int yy = y + i;
-        if (yy < 0)
-          yy = 0;
-        if (yy >= h)
-          yy = h - 1;
-        s += tmp[yy * w + x] * k[i + r];
-      }
-      dst[y * w + x] = s;
-    }
+static float *map_data(InfluenceMap *m, int k) {
+  return k == INF_YOU ? m->iyou
+                      : (k == INF_RIVAL ? m->irival : (k == INF_T ? m->t : m->grad));
+}
+
+static uint16_t *map_q16(InfluenceMap *m, int k) {
+  return k == INF_YOU ? m->qyou
+                      : (k == INF_RIVAL ? m->qrival : (k == INF_T ? m->qt : m->qgrad));
+}
+
+// Q16 steps leave this much room above the maxima seen at the last rebuild;
+// once a head map's peak falls under Q16_MIN_PEAK steps (a bright corner
+// head moved away) the map is rebuilt to regain the resolution
+#define Q16_HEADROOM 4.0f
+#define Q16_MIN_PEAK 1024.0f
+
+// Saturating conversion; flags the map so the next update rebuilds it
+static uint16_t to_q16(InfluenceMap *m, float v, float inv_step) {
+  float q = v * inv_step + 0.5f;
+  if (q <= 0.0f)
+    return 0;
+  if (q >= 65535.0f) {
+    m->qclip = 1;
+    return 65535;
   }
+  return (uint16_t)q;
 }
 
-static void normalize_01(float *a, int n) {
-  float mn = 1e30f, mx = -1e30f;
-  for (int i = 0; i < n; i++) {
-    if (a[i] < mn)
-      mn = a[i];
-    if (a[i] > mx)
-      mx = a[i];
+// Q16 steps from the maxima of the freshly blurred float planes. Territory
+// never exceeds iyou and its gradient stays within sqrt(2) of that, which
+// the headroom covers, so both share the iyou step.
+static void set_q16_steps(InfluenceMap *m, const float *you,
+                          const float *rival) {
+  size_t n = (size_t)m->width * (size_t)m->height;
+  float my = 1e-12f, mr = 1e-12f;
+  for (size_t i = 0; i < n; i++) {
+    my = you[i] > my ? you[i] : my;
+    mr = rival[i] > mr ? rival[i] : mr;
   }
-  float d = mx - mn;
-  if (d < 1e-6f)
-    d = 1.0f;
-  for (int i = 0; i < n; i++)
-    a[i] = (a[i] - mn) / d;
+  m->qstep[INF_YOU] = Q16_HEADROOM * my / 65535.0f;
+  m->qstep[INF_RIVAL] = Q16_HEADROOM * mr / 65535.0f;
+  m->qstep[INF_T] = m->qstep[INF_YOU];
+  m->qstep[INF_GRAD] = m->qstep[INF_YOU];
+  m->qclip = 0;
 }
 
-void compute_influence_full(const Board *b, int self_id, float sigma,
-                            InfluenceMap *out) {
-  int w = b->width, h = b->height;
-  int n = w * h;
-  float *src_you = (float *)calloc((size_t)n, sizeof(float));
-  float *src_rival = (float *)calloc((size_t)n, sizeof(float));
-  float *tmp = (float *)malloc((size_t)n * sizeof(float));
-  if (!src_you || !src_rival || !tmp) {
-    free(src_you);
-    free(src_rival);
-    free(tmp);
-    return;
+// Float planes -> Q16 planes, after a full rebuild. The steps leave room
+// above the maxima, so only the (IIR) undershoot below zero needs a clamp.
+static void pack_q16(InfluenceMap *m, const float *you, const float *rival) {
+  size_t n = (size_t)m->width * (size_t)m->height;
+  float iy = 1.0f / m->qstep[INF_YOU], ir = 1.0f / m->qstep[INF_RIVAL];
+  for (size_t i = 0; i < n; i++) {
+    float qy = you[i] * iy + 0.5f, qr = rival[i] * ir + 0.5f;
+    m->qyou[i] = (uint16_t)(qy > 0.0f ? qy : 0.0f);
+    m->qrival[i] = (uint16_t)(qr > 0.0f ? qr : 0.0f);
   }
-  memset(out->iyou, 0, (size_t)n * sizeof(float));
-  memset(out->irival, 0, (size_t)n * sizeof(float));
-  memset(out->t, 0, (size_t)n * sizeof(float));
-  memset(out->grad, 0, (size_t)n * sizeof(float));
+}
+
+static void block_extrema(InfluenceMap *m, int bx, int by) {
+  int x0 = bx * CENTE_INF_BLOCK, y0 = by * CENTE_INF_BLOCK;
+  int x1 = x0 + CENTE_INF_BLOCK, y1 = y0 + CENTE_INF_BLOCK;
+  if (x1 > m->width)
+    x1 = m->width;
+  if (y1 > m->height)
+    y1 = m->height;
+  size_t nb = (size_t)m->blocks_x * (size_t)m->blocks_y;
+  size_t bi = (size_t)by * (size_t)m->blocks_x + (size_t)bx;
+  for (int k = 0; k < INF_MAPS; k++) {
+    float mn = 1e30f, mx = -1e30f;
+    if (m->qyou) {
+      const uint16_t *a = map_q16(m, k);
+      unsigned qmn = 65535, qmx = 0;
+      for (int y = y0; y < y1; y++)
+        for (int x = x0; x < x1; x++) {
+          unsigned v = a[y * m->width + x];
+          qmn = v < qmn ? v : qmn;
+          qmx = v > qmx ? v : qmx;
+        }
+      mn = (float)qmn;
+      mx = (float)qmx;
+    } else {
+      const float *a = map_data(m, k);
+      for (int y = y0; y < y1; y++)
+        for (int x = x0; x < x1; x++) {
+          float v = a[y * m->width + x];
+          if (v < mn)
+            mn = v;
+          if (v > mx)
+            mx = v;
+        }
+    }
+    m->blk_lo[k * nb + bi] = mn;
+    m->blk_hi[k * nb + bi] = mx;
+  }
+}
+
+// Global min/max from the block summaries, then the normalisation factors
+static void reduce_extrema(InfluenceMap *m) {
+  size_t nb = (size_t)m->blocks_x * (size_t)m->blocks_y;
+  for (int k = 0; k < INF_MAPS; k++) {
+    float mn = 1e30f, mx = -1e30f;
+    for (size_t i = 0; i < nb; i++) {
+      if (m->blk_lo[k * nb + i] < mn)
+        mn = m->blk_lo[k * nb + i];
+      if (m->blk_hi[k * nb + i] > mx)
+        mx = m->blk_hi[k * nb + i];
+    }
+    float d = mx - mn;
+    if (d < 1e-6f)
+      d = 1.0f;
+    m->lo[k] = mn;
+    m->scale[k] = 1.0f / d;
+  }
+}
+
+// Territory t = max(0, you - rival) over the window and its gradient over the
+// window grown by one cell to the right and bottom (backward differences)
+static void territory_float(InfluenceMap *m, int x0, int y0, int x1, int y1) {
+  int w = m->width, h = m->height;
+  for (int y = y0; y <= y1; y++)
+    for (int x = x0; x <= x1; x++) {
+      int i = y * w + x;
+      float t = m->iyou[i] - m->irival[i];
+      m->t[i] = t > 0.0f ? t : 0.0f;
+    }
+  if (x1 < w - 1)
+    x1++;
+  if (y1 < h - 1)
+    y1++;
+  for (int y = y0; y <= y1; y++)
+    for (int x = x0; x <= x1; x++) {
+      int i = y * w + x;
+      float gx = m->t[i] - m->t[y * w + (x > 0 ? x - 1 : x)];
+      float gy = m->t[i] - m->t[(y > 0 ? y - 1 : y) * w + x];
+      m->grad[i] = sqrtf(gx * gx + gy * gy);
+    }
+}
+
+// territory_float on the Q16 planes, computing in float
+static void territory_q16(InfluenceMap *m, int x0, int y0, int x1, int y1) {
+  int w = m->width, h = m->height;
+  float sy = m->qstep[INF_YOU], sr = m->qstep[INF_RIVAL];
+  float st = m->qstep[INF_T], it = 1.0f / st, ig = 1.0f / m->qstep[INF_GRAD];
+  for (int y = y0; y <= y1; y++)
+    for (int x = x0; x <= x1; x++) {
+      int i = y * w + x;
+      m->qt[i] =
+          to_q16(m, (float)m->qyou[i] * sy - (float)m->qrival[i] * sr, it);
+    }
+  if (x1 < w - 1)
+    x1++;
+  if (y1 < h - 1)
+    y1++;
+  for (int y = y0; y <= y1; y++)
+    for (int x = x0; x <= x1; x++) {
+      int i = y * w + x;
+      float gx = st * ((float)m->qt[i] - (float)m->qt[y * w + (x > 0 ? x - 1 : x)]);
+      float gy = st * ((float)m->qt[i] - (float)m->qt[(y > 0 ? y - 1 : y) * w + x]);
+      m->qgrad[i] = to_q16(m, sqrtf(gx * gx + gy * gy), ig);
+    }
+}
 
-  // Seeds: heads contribute strong influence; bodies weak; free points mild
-  // based on value
-  for (int y = 0; y < h; y++) {
-    for (int x = 0; x < w; x++) {
-      int c = b->cells[y * w + x];
-      float v = (c > 0) ? (0.2f + 0.8f * (float)c / 255.0f) : 0.05f;
-      src_you[y * w + x] = 0.0f;
-      src_rival[y * w + x] = 0.0f;
-      (void)v;
+// Recomputes territory and gradient inside [x0,x1]x[y0,y1] (the gradient
+// reaches one cell further right/down) and the block extrema it touches
+static void refresh_window(InfluenceMap *m, int x0, int y0, int x1, int y1) {
+  int w = m->width, h = m->height;
+  if (m->qyou)
+    territory_q16(m, x0, y0, x1, y1);
+  else
+    territory_float(m, x0, y0, x1, y1);
+  if (x1 < w - 1)
+    x1++;
+  if (y1 < h - 1)
+    y1++;
+  for (int by = y0 / CENTE_INF_BLOCK; by <= y1 / CENTE_INF_BLOCK; by++)
+    for (int bx = x0 / CENTE_INF_BLOCK; bx <= x1 / CENTE_INF_BLOCK; bx++)
+      block_extrema(m, bx, by);
+}
+
+// Points m->kernel at the cached kernel for `sigma` (already quantised),
+// building it in the least recently used slot on a miss
+static int ensure_kernel(InfluenceMap *m, float sigma) {
+  m->kclock++;
+  if (m->cur && m->sigma == sigma) {
+    m->cur->last_use = m->kclock;
+    return 0;
+  }
+  CenteKernel *slot = &m->kcache[0];
+  for (int i = 0; i < CENTE_KERNEL_CACHE; i++) {
+    CenteKernel *c = &m->kcache[i];
+    if (c->taps && c->sigma == sigma) {
+      slot = c;
+      break;
     }
+    if (!c->taps || (slot->taps && c->last_use < slot->last_use))
+      slot = c;
   }
-  // Heads as strong Gaussians
+  if (!slot->taps || slot->sigma != sigma) {
+    free(slot->taps);
+    slot->taps = gaussian_kernel_1d(sigma, &slot->radius);
+    slot->sigma = sigma;
+    slot->has_iir = 0;
+    if (!slot->taps) {
+      m->cur = NULL;
+      return -1;
+    }
+  }
+  slot->last_use = m->kclock;
+  m->cur = slot;
+  m->kernel = slot->taps;
+  m->radius = slot->radius;
+  m->sigma = sigma;
+  return 0;
+}
+
+// Grows the aligned scratch to `floats`; the seed planes start out zeroed
+static float *ensure_work(InfluenceMap *m, size_t floats) {
+  if (m->work_cap >= floats)
+    return m->work;
+  void *p = NULL;
+  if (posix_memalign(&p, 64, floats * sizeof(float)) != 0)
+    return NULL;
+  free(m->work);
+  m->work = (float *)p;
+  m->work_cap = floats;
+  memset(m->work, 0, floats * sizeof(float));
+  return m->work;
+}
+
+static size_t plane(const InfluenceMap *m) {
+  return (size_t)m->width * (size_t)m->height;
+}
+
+static int use_iir(const InfluenceMap *m) {
+  return m->blur == CENTE_BLUR_IIR ||
+         (m->blur == CENTE_BLUR_AUTO && m->radius > CENTE_BLUR_IIR_RADIUS);
+}
+
+// The seeds are single cells, so each blurred map is a sum of separable
+// outer products: one x and one y recursive response per head, then a
+// row-wise axpy. O(P * w * h) regardless of sigma.
+static int blur_heads_iir(const Board *b, int self_id, InfluenceMap *out) {
+  CenteKernel *c = out->cur;
+  if (!c->has_iir) {
+    convolve_iir_setup(&c->iir, c->sigma);
+    c->has_iir = 1;
+  }
+  int w = b->width, h = b->height;
+  size_t n = plane(out);
+  // Line responses after the seed planes, then the double work (even offset
+  // keeps it 8-byte aligned)
+  size_t line = (size_t)(w + h + 1) & ~(size_t)1;
+  size_t len = (size_t)(w > h ? w : h);
+  size_t dbl = 2 * convolve_iir_scratch(&c->iir, len);
+  // Compact maps blur into two float planes past the doubles, then pack
+  size_t planes = out->qyou ? 2 * n : 0;
+  if (!ensure_work(out, 2 * n + line + dbl + planes))
+    return -1;
+  float *fx = out->work + 2 * n, *fy = fx + w;
+  double *buf = (double *)(void *)(out->work + 2 * n + line);
+  float *you = out->qyou ? out->work + 2 * n + line + dbl : out->iyou;
+  float *rival = out->qyou ? you + n : out->irival;
+  memset(you, 0, n * sizeof(float));
+  memset(rival, 0, n * sizeof(float));
+  for (int p = 0; p < b->num_players; p++) {
+    float *a = p == self_id ? you : rival;
+    convolve_iir_impulse(&c->iir, w, b->head_x[p], fx, buf);
+    convolve_iir_impulse(&c->iir, h, b->head_y[p], fy, buf);
+    for (int y = 0; y < h; y++)
+      convolve_axpy(a + (size_t)y * (size_t)w, fx, fy[y], w);
+  }
+  if (out->qyou) {
+    set_q16_steps(out, you, rival);
+    pack_q16(out, you, rival);
+  }
+  return 0;
+}
+
+// Heads as strong Gaussians: unit impulses in the (all-zero) seed planes
+static void seed_heads(const Board *b, int self_id, float *src_you,
+                       float *src_rival, float v) {
   for (int p = 0; p < b->num_players; p++) {
-    int hx = b->head_x[p];
-    int hy = b->head_y[p];
-    int idxh = hy * w + hx;
+    int idxh = b->head_y[p] * b->width + b->head_x[p];
     if (p == self_id)
-      src_you[idxh] = 1.0f;
+      src_you[idxh] = v;
     else
-      src_rival[idxh] = 1.0f;
+      src_rival[idxh] = v;
+  }
+}
+
+static void finish_full(const Board *b, int self_id, InfluenceMap *out) {
+  for (int p = 0; p < b->num_players; p++) {
+    out->seed_x[p] = b->head_x[p];
+    out->seed_y[p] = b->head_y[p];
+  }
+  refresh_window(out, 0, 0, b->width - 1, b->height - 1);
+  reduce_extrema(out);
+  out->self_id = self_id;
+  out->num_players = b->num_players;
+  out->updates = 0;
+  out->valid = 1;
+}
+
+// Full rebuild of every map in outs[0..count) whose kernel is already set.
+// FIR maps convolve the seed planes of the first FIR map's scratch.
+static void rebuild(const Board *b, int self_id, InfluenceMap **outs,
+                    int count) {
+  InfluenceMap *owner = NULL;
+  size_t need = 0;
+  for (int i = 0; i < count; i++) {
+    if (use_iir(outs[i])) {
+      if (blur_heads_iir(b, self_id, outs[i]) == 0)
+        finish_full(b, self_id, outs[i]);
+      continue;
+    }
+    // Compact maps convolve into two float planes after the scratch
+    size_t s = 2 * plane(outs[i]) +
+               convolve_scratch_floats(b->width, b->height, outs[i]->radius) +
+               (outs[i]->qyou ? 2 * plane(outs[i]) : 0);
+    if (s > need)
+      need = s;
+    if (!owner)
+      owner = outs[i];
+  }
+  if (!owner || !ensure_work(owner, need))
+    return;
+  size_t n = plane(owner);
+  float *src_you = owner->work, *src_rival = owner->work + n;
+  seed_heads(b, self_id, src_you, src_rival, 1.0f);
+  for (int i = 0; i < count; i++) {
+    InfluenceMap *m = outs[i];
+    if (use_iir(m))
+      continue;
+    float *scratch = owner->work + 2 * n;
+    float *you = m->iyou, *rival = m->irival;
+    if (m->qyou) {
+      you = scratch + convolve_scratch_floats(b->width, b->height, m->radius);
+      rival = you + n;
+    }
+    convolve_separable2(src_you, src_rival, you, rival, b->width, b->height,
+                        m->kernel, m->radius, scratch);
+    if (m->qyou) {
+      set_q16_steps(m, you, rival);
+      pack_q16(m, you, rival);
+    }
+    finish_full(b, self_id, m);
   }
+  seed_heads(b, self_id, src_you, src_rival, 0.0f);
+}
 
-  float *k;
-  int r;
-  gaussian_kernel_1d(sigma, &k, &r);
-  if (!k) {
-    free(src_you);
-    free(src_rival);
-    free(tmp);
+void compute_influence_full(const Board *b, int self_id, float sigma,
+                            InfluenceMap *out) {
+  out->valid = 0;
+  if (ensure_kernel(out, quantise_sigma(sigma)) != 0)
     return;
+  rebuild(b, self_id, &out, 1);
+}
+
+// Response of the border-clamped 1D convolution to a unit impulse at s,
+// for x in [*x0, *x0 + count)
+static int impulse_response(const float *k, int r, int s, int len, int *x0,
+                            float *out) {
+  int lo = s - r < 0 ? 0 : s - r;
+  int hi = s + r > len - 1 ? len - 1 : s + r;
+  for (int x = lo; x <= hi; x++) {
+    float v = 0.0f;
+    for (int i = -r; i <= r; i++) {
+      int xx = x + i;
+      if (xx < 0)
+        xx = 0;
+      if (xx >= len)
+        xx = len - 1;
+      if (xx == s)
+        v += k[i + r];
+    }
+    out[x - lo] = v;
   }
-  convolve_separable(src_you, tmp, out->iyou, w, h, k, r);
-  convolve_separable(src_rival, tmp, out->irival, w, h, k, r);
+  *x0 = lo;
+  return hi - lo + 1;
+}
 
-  // Territory and gradient magnitude
-  for (int i = 0; i < n; i++) {
-    float t = out->iyou[i] - out->irival[i];
-    out->t[i] = t > 0.0f ? t : 0.0f;
+static void stamp(InfluenceMap *m, int map, int sx, int sy, float sign,
+                  float *fx, float *fy, int *win) {
+  int x0, y0;
+  int nx = impulse_response(m->kernel, m->radius, sx, m->width, &x0, fx);
+  int ny = impulse_response(m->kernel, m->radius, sy, m->height, &y0, fy);
+  size_t at = (size_t)y0 * (size_t)m->width + (size_t)x0;
+  if (m->qyou) {
+    // Each stamp is rounded to whole steps; the periodic rebuild bounds the
+    // drift just as it does for float
+    uint16_t *a = map_q16(m, map) + at;
+    float inv = 1.0f / m->qstep[map];
+    for (int j = 0; j < ny; j++) {
+      uint16_t *row = a + (size_t)j * (size_t)m->width;
+      float vy = sign * fy[j] * inv;
+      for (int i = 0; i < nx; i++) {
+        float d = vy * fx[i];
+        long v = (long)row[i] + (long)(d < 0.0f ? d - 0.5f : d + 0.5f);
+        if (v > 65535) {
+          m->qclip = 1;
+          v = 65535;
+        }
+        row[i] = (uint16_t)(v < 0 ? 0 : v);
+      }
+    }
+  } else {
+    float *a = map_data(m, map) + at;
+    for (int j = 0; j < ny; j++) {
+      float *row = a + (size_t)j * (size_t)m->width;
+      float vy = sign * fy[j];
+      for (int i = 0; i < nx; i++)
+        row[i] += vy * fx[i];
+    }
   }
-  normalize_01(out->iyou, n);
-  normalize_01(out->irival, n);
-  normalize_01(out->t, n);
+  win[0] = x0;
+  win[1] = y0;
+  win[2] = x0 + nx - 1;
+  win[3] = y0 + ny - 1;
+}
 
-  for (int y = 0; y < h; y++) {
-    for (int x = 0; x < w; x++) {
-      int i = y * w + x;
-      float tx1 = out->t[i] - out->t[y * w + (x > 0 ? x - 1 : x)];
-      float ty1 = out->t[i] - out->t[(y > 0 ? y - 1 : y) * w + x];
-      float gx = fabsf(tx1);
-      float gy = fabsf(ty1);
-      out->grad[i] = sqrtf(gx * gx + gy * gy);
+// Incremental update of `out`, whose kernel is current. Returns 0 if the
+// caller must rebuild it instead.
+static int try_update(const Board *b, int self_id, InfluenceMap *out) {
+  if (!out->valid || out->self_id != self_id ||
+      out->num_players != b->num_players ||
+      out->updates >= CENTE_INFLUENCE_REFRESH || use_iir(out))
+    return 0;
+  int moved[CENTE_MAX_PLAYERS];
+  int nm = 0;
+  for (int p = 0; p < b->num_players; p++)
+    if (out->seed_x[p] != b->head_x[p] || out->seed_y[p] != b->head_y[p])
+      moved[nm++] = p;
+  if (nm == 0)
+    return 1;
+  // Stamping plus refreshing 2*nm windows vs two separable convolutions
+  long span = 2L * out->radius + 1;
+  long n = (long)b->width * (long)b->height;
+  long area = span * span < n ? span * span : n;
+  if ((long)nm * 8L * area >= n * (4L * span + 4L))
+    return 0;
+  if (!ensure_work(out, 2 * plane(out) + 2 * (size_t)span))
+    return 0;
+
+  float *fx = out->work + 2 * plane(out);
+  float *fy = fx + span;
+  int win[2 * CENTE_MAX_PLAYERS][4];
+  for (int k = 0; k < nm; k++) {
+    int p = moved[k];
+    int map = p == self_id ? INF_YOU : INF_RIVAL;
+    stamp(out, map, out->seed_x[p], out->seed_y[p], -1.0f, fx, fy, win[2 * k]);
+    stamp(out, map, b->head_x[p], b->head_y[p], 1.0f, fx, fy, win[2 * k + 1]);
+    out->seed_x[p] = b->head_x[p];
+    out->seed_y[p] = b->head_y[p];
+  }
+  for (int k = 0; k < 2 * nm; k++)
+    refresh_window(out, win[k][0], win[k][1], win[k][2], win[k][3]);
+  // A head reached a cell brighter than the Q16 range: rescale from scratch
+  if (out->qclip)
+    return 0;
+  reduce_extrema(out);
+  if (out->qyou && (out->lo[INF_YOU] + 1.0f / out->scale[INF_YOU] < Q16_MIN_PEAK ||
+                    out->lo[INF_RIVAL] + 1.0f / out->scale[INF_RIVAL] <
+                        Q16_MIN_PEAK))
+    return 0;
+  out->updates++;
+  return 1;
+}
+
+void compute_influence_multi(const Board *b, int self_id, const float *sigmas,
+                             InfluenceMap **outs, int count) {
+  InfluenceMap *full[CENTE_KERNEL_CACHE];
+  int nf = 0;
+  for (int i = 0; i < count; i++) {
+    InfluenceMap *m = outs[i];
+    float q = quantise_sigma(sigmas[i]);
+    int same = m->cur && m->sigma == q;
+    if (ensure_kernel(m, q) != 0) {
+      m->valid = 0;
+      continue;
+    }
+    if (same && try_update(b, self_id, m))
+      continue;
+    m->valid = 0;
+    if (nf == CENTE_KERNEL_CACHE) {
+      rebuild(b, self_id, full, nf);
+      nf = 0;
     }
+    full[nf++] = m;
   }
-  normalize_01(out->grad, n);
+  if (nf > 0)
+    rebuild(b, self_id, full, nf);
+}
 
-  free(src_you);
-  free(src_rival);
-  free(tmp);
-  free(k);
+void compute_influence_update(const Board *b, int self_id, float sigma,
+                              InfluenceMap *out) {
+  compute_influence_multi(b, self_id, &sigma, &out, 1);
 }
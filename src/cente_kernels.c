@@ -0,0 +1,42 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include "include/cente_kernels.h"
+#include <stddef.h>
+
+#define KERNEL_TABLE(W, H, S)                                                  \
+  {W,                                                                          \
+   H,                                                                          \
+   #W "x" #H,                                                                  \
+   board_count_stats_##S,                                                      \
+   prior_cente_batch_##W##x##H},
+
+static const CenteKernels TABLES[] = {CENTE_KERNEL_SIZES(KERNEL_TABLE)};
+
+static const CenteKernels GENERIC = {
+    0,
+    0,
+    "generic",
+    board_count_stats_generic,
+    prior_cente_batch_generic,
+};
+
+static const CenteKernels *g_kernels = &GENERIC;
+
+const CenteKernels *kernels_lookup(int width, int height) {
+  for (size_t i = 0; i < sizeof(TABLES) / sizeof(TABLES[0]); i++)
+    if (TABLES[i].width == width && TABLES[i].height == height)
+      return &TABLES[i];
+  return NULL;
+}
+
+void kernels_init(int width, int height) {
+  const CenteKernels *k = kernels_lookup(width, height);
+  g_kernels = k ? k : &GENERIC;
+}
+
+const CenteKernels *kernels_for(int width, int height) {
+  return g_kernels->width == width && g_kernels->height == height ? g_kernels
+                                                                  : &GENERIC;
+}
+
+const CenteKernels *kernels_generic(void) { return &GENERIC; }
@@ -1,155 +1,387 @@
 // This is a personal academic project. Dear PVS-Studio, please check it.
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 #include "include/cente_mcts.h"
+#include "include/cente_rollout.h"
+#include "include/cente_voronoi.h"
+#include "include/cente_zobrist.h"
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/time.h>
+
+#define CENTE_MAX_DEPTH 64
+
+struct MCTSTree {
+  MCTSNode *nodes;
+  MCTSNode *spare; // compaction target, swapped with nodes
+  int capacity;
+  int used;
+  int root;
+  int width, height;
+  Board scratch; // descent/playout board, cells owned by the tree
+  VoronoiScratch *voronoi; // leaf territory evaluation
+  int last_iters;          // of the last mcts_search
+  int last_depth;
+};
 
 static cente_mcts_params G_PARAMS;
+static MCTSTree *G_TREE = NULL; // backs the stateless mcts_select
 
-static unsigned long long now_ms(void) {
-  struct timeval tv;
-  gettimeofday(&tv, NULL);
-  return (unsigned long long)tv.tv_sec * 1000ULL +
-         (unsigned long long)(tv.tv_usec / 1000ULL);
+void mcts_reset(void) {
+  if (G_TREE)
+    G_TREE->used = 0;
 }
 
-void mcts_reset(void) {}
-
 void mcts_set_params(const cente_mcts_params *params) { G_PARAMS = *params; }
 void mcts_set_size_params(const cente_size_params *size_params) {
   G_PARAMS = size_params->mcts;
 }
 
-static void softmax_inplace(float *a, int n) {
-  float mx = -1e30f;
-  for (int i = 0; i < n; i++)
-    if (a[i] > mx)
-      mx = a[i];
-  float sum = 0.0f;
-  for (int i = 0; i < n; i++) {
-    a[i] = expf(a[i] - mx);
-    sum += a[i];
-  }
-  float inv = sum > 1e-9f ? 1.0f / sum : 1.0f;
-  for (int i = 0; i < n; i++)
-    a[i] *= inv;
+// Legal moves (at most CENTE_MAX_CHILDREN) in admission order; their priors
+// are computed as widening admits them
+static int generate_candidates(const Board *b, int self_id,
+                               const InfluenceMap *inf, CenteMove out[]) {
+  int n = board_legal_moves(b, self_id, out, CENTE_MAX_CHILDREN);
+  prior_cente_order(b, inf, out, n);
+  return n;
 }
 
-static int generate_candidates(const Board *b, int self_id,
-                               const InfluenceMap *inf, CenteMove out[],
-                               float priors[], int maxk) {
-  // All legal up to maxk, scored by prior_cente
-  CenteMove tmp[64];
-  int n = board_legal_moves(b, self_id, tmp, 64);
-  if (n == 0)
-    return 0;
-  if (n > maxk)
-    n = maxk;
-  for (int i = 0; i < n; i++) {
-    out[i] = tmp[i];
-    priors[i] = prior_cente(b, self_id, inf, tmp[i]);
+// Children a node with this many visits may have: k_base, plus k_inc for
+// each of t1, t2, t3 reached. Without params every candidate is admitted.
+static int widen_target(const MCTSNode *nd, const cente_mcts_params *params) {
+  if (!params)
+    return CENTE_MAX_CHILDREN;
+  int k = params->k_base < 1 ? 1 : params->k_base;
+  int inc = params->k_inc > 0 ? params->k_inc : 0;
+  k += inc * ((nd->visits >= params->t1) + (nd->visits >= params->t2) +
+              (nd->visits >= params->t3));
+  return k;
+}
+
+// Scores candidates [num_children, target) and admits them. Priors stay a
+// softmax over the admitted children: raw priors lie in [0,1], so the
+// running sum of their exponentials renormalises without a max shift.
+static void admit_children(MCTSNode *nd, const Board *b, int self_id,
+                           const InfluenceMap *inf, int target) {
+  if (target > nd->num_legal)
+    target = nd->num_legal;
+  int a0 = nd->num_children, n = target - a0;
+  if (n <= 0)
+    return;
+  float raw[CENTE_MAX_CHILDREN];
+  prior_cente_batch(b, self_id, inf, nd->actions + a0, n, raw);
+  float add = 0.0f;
+  for (int j = 0; j < n; j++) {
+    raw[j] = expf(raw[j]);
+    add += raw[j];
   }
-  // Sort by prior descending to claim urgent cells first
-  for (int i = 0; i < n; i++) {
-    int best = i;
-    for (int j = i + 1; j < n; j++)
-      if (priors[j] > priors[best])
-        best = j;
-    if (best != i) {
-      float tp = priors[i];
-      priors[i] = priors[best];
-      priors[best] = tp;
-      CenteMove tm = out[i];
-      out[i] = out[best];
-      out[best] = tm;
-    }
+  float mass = nd->prior_mass + add;
+  float keep = nd->prior_mass / mass;
+  for (int a = 0; a < a0; a++)
+    nd->priors[a] *= keep;
+  for (int j = 0; j < n; j++) {
+    nd->priors[a0 + j] = raw[j] / mass;
+    nd->child_visits[a0 + j] = 0;
+    nd->child_q[a0 + j] = 0.0f;
+    nd->children[a0 + j] = -1;
   }
-  softmax_inplace(priors, n);
-  return n;
+  nd->prior_mass = mass;
+  nd->num_children = target;
 }
 
-static float rollout_policy(const Board *b, int self_id,
-                            const InfluenceMap *inf, const cente_weights *w) {
-  // One-step value proxy
-  return value_eval(b, self_id, inf, w);
+// Share of the reachable value self_id gets to first; sees the walls the
+// influence map blurs over
+static float territory_share(MCTSTree *t, Board *b, int self_id) {
+  VoronoiResult vr;
+  voronoi_eval(b, t->voronoi, &vr);
+  long long total = 0;
+  for (int p = 0; p < b->num_players; p++)
+    total += vr.value[p];
+  return total > 0 ? (float)vr.value[self_id] / (float)total : 0.0f;
 }
 
-static float simulate_once(Board *root, int self_id, const InfluenceMap *inf,
-                           const cente_weights *w) {
-  // Stateless light simulation: evaluate current state
-  (void)root;
-  (void)self_id;
-  return rollout_policy(root, self_id, inf, w);
+static float simulate_once(MCTSTree *t, int self_id, const InfluenceMap *inf,
+                           const cente_weights *w,
+                           const cente_mcts_params *params, CenteRng *rng) {
+  const cente_mcts_params *mp = params ? params : &G_PARAMS;
+  Board *scratch = &t->scratch;
+  float r = rollout_run(scratch, self_id, inf, w, mp->rollout_depth,
+                        mp->epsilon_rollout, rng);
+  if (CENTE_VORONOI_WEIGHT <= 0.0f || !t->voronoi || scratch->blocked[self_id])
+    return r;
+  return (1.0f - CENTE_VORONOI_WEIGHT) * r +
+         CENTE_VORONOI_WEIGHT * territory_share(t, scratch, self_id);
 }
 
-CenteMove mcts_select(const Board *root, int self_id, const InfluenceMap *inf,
-                      const cente_weights *w, const cente_mcts_params *params,
-                      int budget_ms) {
-  unsigned long long deadline = now_ms() + (unsigned long long)budget_ms;
-  CenteMove best = {.x = root->head_x[self_id], .y = root->head_y[self_id]};
+MCTSTree *mcts_tree_create(int width, int height, int capacity) {
+  MCTSTree *t = (MCTSTree *)calloc(1, sizeof(MCTSTree));
+  if (!t)
+    return NULL;
+  if (capacity < 2)
+    capacity = 2;
+  t->nodes = (MCTSNode *)malloc((size_t)capacity * sizeof(MCTSNode));
+  t->spare = (MCTSNode *)malloc((size_t)capacity * sizeof(MCTSNode));
+  t->voronoi = voronoi_create(width, height);
+  if (!t->nodes || !t->spare || !t->voronoi ||
+      board_init_storage(&t->scratch, width, height) != 0) {
+    mcts_tree_destroy(t);
+    return NULL;
+  }
+  t->capacity = capacity;
+  t->width = width;
+  t->height = height;
+  t->used = 0;
+  t->root = -1;
+  return t;
+}
 
-  // Root candidates
-  CenteMove actions[CENTE_MAX_CHILDREN];
-  float priors[CENTE_MAX_CHILDREN];
-  int cap = params ? params->k_base : CENTE_MAX_CHILDREN;
-  if (cap > CENTE_MAX_CHILDREN)
-    cap = CENTE_MAX_CHILDREN;
-  if (cap < 1)
-    cap = 1;
-  int K = generate_candidates(root, self_id, inf, actions, priors, cap);
-  if (K == 0)
-    return best;
+void mcts_tree_destroy(MCTSTree *t) {
+  if (!t)
+    return;
+  free(t->nodes);
+  free(t->spare);
+  board_free_storage(&t->scratch);
+  voronoi_destroy(t->voronoi);
+  free(t);
+}
 
-  float q[CENTE_MAX_CHILDREN];
-  int nvis[CENTE_MAX_CHILDREN];
-  for (int i = 0; i < K; i++) {
-    q[i] = 0.0f;
-    nvis[i] = 0;
-  }
-  int total = 0;
-
-  while ((int)(deadline - now_ms()) > 1) {
-    // PUCT selection at root only (shallow tree due to time constraints)
-    int arg = 0;
-    float best_score = -1e30f;
-    float sqrt_total = sqrtf((float)(total + 1));
-    for (int i = 0; i < K; i++) {
-      float c_puct = params ? params->c_puct : G_PARAMS.c_puct;
-      float u =
-          q[i] + c_puct * priors[i] * sqrt_total / (1.0f + (float)nvis[i]);
-      if (u > best_score) {
-        best_score = u;
-        arg = i;
+static int node_alloc(MCTSTree *t) {
+  if (t->used >= t->capacity)
+    return -1;
+  int i = t->used++;
+  MCTSNode *nd = &t->nodes[i];
+  nd->hash = 0;
+  nd->visits = 0;
+  nd->value_sum = 0.0f;
+  nd->num_children = 0;
+  nd->num_legal = 0;
+  nd->prior_mass = 0.0f;
+  nd->expanded = 0;
+  return i;
+}
+
+// Copies the subtree rooted at `i` into t->spare, returning its new index
+static int compact_copy(MCTSTree *t, int i, int *used) {
+  int j = (*used)++;
+  t->spare[j] = t->nodes[i];
+  MCTSNode *nd = &t->spare[j];
+  for (int a = 0; a < nd->num_children; a++)
+    if (nd->children[a] >= 0)
+      nd->children[a] = compact_copy(t, nd->children[a], used);
+  return j;
+}
+
+static void tree_reroot(MCTSTree *t, int new_root) {
+  t->root = new_root;
+  if (t->used < t->capacity / 2)
+    return;
+  // Drop everything outside the kept subtree so it can keep growing
+  int used = 0;
+  t->root = compact_copy(t, new_root, &used);
+  MCTSNode *tmp = t->nodes;
+  t->nodes = t->spare;
+  t->spare = tmp;
+  t->used = used;
+}
+
+static void tree_clear(MCTSTree *t) {
+  t->used = 0;
+  t->root = node_alloc(t);
+}
+
+void mcts_tree_clear(MCTSTree *t) { tree_clear(t); }
+
+static void node_expand(MCTSNode *nd, const Board *b, int self_id,
+                        const InfluenceMap *inf,
+                        const cente_mcts_params *params) {
+  nd->num_legal = generate_candidates(b, self_id, inf, nd->actions);
+  nd->num_children = 0;
+  nd->prior_mass = 0.0f;
+  admit_children(nd, b, self_id, inf, widen_target(nd, params));
+  nd->expanded = 1;
+}
+
+int mcts_tree_set_root(MCTSTree *t, const Board *root, int self_id) {
+  (void)self_id;
+  uint64_t h = zobrist_hash_board(root);
+  if (t->root >= 0 && t->root < t->used && t->nodes[t->root].expanded &&
+      t->nodes[t->root].hash == h)
+    return 1;
+  tree_clear(t);
+  t->nodes[t->root].hash = h;
+  return 0;
+}
+
+int mcts_tree_advance(MCTSTree *t, const Board *root, int self_id,
+                      CenteMove played, Board *predicted) {
+  board_copy_into(predicted, root);
+  board_apply_move(predicted, self_id, played);
+  rollout_predict_replies(predicted, self_id);
+  uint64_t h = zobrist_hash_board(predicted);
+  if (t->root >= 0 && t->root < t->used) {
+    MCTSNode *nd = &t->nodes[t->root];
+    for (int a = 0; a < nd->num_children; a++) {
+      if (nd->actions[a].x != played.x || nd->actions[a].y != played.y)
+        continue;
+      int c = nd->children[a];
+      if (c >= 0 && t->nodes[c].expanded && t->nodes[c].hash == h) {
+        tree_reroot(t, c);
+        return 1;
       }
+      break;
+    }
+  }
+  tree_clear(t);
+  t->nodes[t->root].hash = h;
+  return 0;
+}
+
+static int puct_pick(const MCTSNode *nd, float c_puct) {
+  int arg = 0;
+  float best_score = -1e30f;
+  float sqrt_total = sqrtf((float)(nd->visits + 1));
+  for (int i = 0; i < nd->num_children; i++) {
+    float u = nd->child_q[i] + c_puct * nd->priors[i] * sqrt_total /
+                                   (1.0f + (float)nd->child_visits[i]);
+    if (u > best_score) {
+      best_score = u;
+      arg = i;
     }
-    // Apply action virtually
-    Board bcopy = *root;
-    size_t n = (size_t)root->width * (size_t)root->height;
-    bcopy.cells = (int *)malloc(n * sizeof(int));
-    if (!bcopy.cells)
+  }
+  return arg;
+}
+
+// One selection / expansion / playout / backup pass from the root; returns
+// how many of our moves the descent played
+static int search_iteration(MCTSTree *t, const Board *root, int self_id,
+                             const InfluenceMap *inf, const cente_weights *w,
+                             const cente_mcts_params *params, CenteRng *rng) {
+  const cente_mcts_params *mp = params ? params : &G_PARAMS;
+  int path_node[CENTE_MAX_DEPTH];
+  int path_act[CENTE_MAX_DEPTH];
+  int depth = 0;
+  Board *b = &t->scratch;
+  board_copy_into(b, root);
+
+  float r;
+  int ni = t->root;
+  for (;;) {
+    MCTSNode *nd = &t->nodes[ni];
+    if (!nd->expanded) {
+      nd->hash = zobrist_hash_board(b);
+      node_expand(nd, b, self_id, inf, params);
+    } else if (nd->num_children < nd->num_legal) {
+      admit_children(nd, b, self_id, inf, widen_target(nd, params));
+    }
+    if (nd->num_children == 0) {
+      r = 0.0f; // no legal move left: we are blocked here
       break;
-    memcpy(bcopy.cells, root->cells, n * sizeof(int));
-    board_apply_move(&bcopy, self_id, actions[arg]);
+    }
+    int a = puct_pick(nd, mp->c_puct);
+    path_node[depth] = ni;
+    path_act[depth] = a;
+    depth++;
+    board_apply_move(b, self_id, nd->actions[a]);
+    if (nd->children[a] < 0 || depth >= CENTE_MAX_DEPTH) {
+      if (depth < CENTE_MAX_DEPTH) {
+        int c = node_alloc(t);
+        // node_alloc may be out of room; the playout still counts
+        t->nodes[ni].children[a] = c;
+      }
+      r = simulate_once(t, self_id, inf, w, params, rng);
+      break;
+    }
+    ni = nd->children[a];
+    rollout_predict_replies(b, self_id);
+  }
 
-    float r = simulate_once(&bcopy, self_id, inf, w);
+  for (int d = depth - 1; d >= 0; d--) {
+    MCTSNode *nd = &t->nodes[path_node[d]];
+    int a = path_act[d];
+    nd->visits++;
+    nd->value_sum += r;
+    nd->child_visits[a]++;
+    nd->child_q[a] += (r - nd->child_q[a]) / (float)nd->child_visits[a];
+  }
+  return depth;
+}
 
-    free(bcopy.cells);
-    total++;
-    nvis[arg]++;
-    q[arg] += (r - q[arg]) / (float)nvis[arg];
+CenteMove mcts_search(MCTSTree *t, const Board *root, int self_id,
+                      const InfluenceMap *inf, const cente_weights *w,
+                      const cente_mcts_params *params,
+                      const CenteBudget *budget, const volatile int *stop) {
+  CenteSearchClock clk;
+  search_clock_start(&clk, budget);
+  CenteMove best = {.x = root->head_x[self_id], .y = root->head_y[self_id]};
+  t->last_iters = 0;
+  t->last_depth = 0;
+  if (t->root < 0 || t->root >= t->used)
+    mcts_tree_set_root(t, root, self_id);
+
+  eval_init(root->width, root->height);
+  MCTSNode *rn = &t->nodes[t->root];
+  if (!rn->expanded)
+    node_expand(rn, root, self_id, inf, params);
+  if (rn->num_children == 0)
+    return best;
+
+  rollout_init(root->width, root->height);
+  CenteRng rng;
+  cente_rng_seed(&rng, (uint64_t)clk.start_ms * 0x9e3779b97f4a7c15ULL ^
+                           (uint64_t)(self_id + 1));
+
+  // search_iteration never reallocates the node array
+  while (!(stop && *stop) &&
+         !search_clock_done(&clk, rn->child_visits, rn->num_children)) {
+    int d = search_iteration(t, root, self_id, inf, w, params, &rng);
+    if (d > t->last_depth)
+      t->last_depth = d;
+    t->last_iters++;
   }
 
   // Choose by visits or q
   int best_i = 0;
   float best_v = -1e30f;
-  for (int i = 0; i < K; i++) {
-    float v = (float)nvis[i] + 1e-3f * q[i];
+  for (int i = 0; i < rn->num_children; i++) {
+    float v = (float)rn->child_visits[i] + 1e-3f * rn->child_q[i];
     if (v > best_v) {
       best_v = v;
       best_i = i;
     }
   }
-  return actions[best_i];
+  return rn->actions[best_i];
+}
+
+int mcts_root_visits(const MCTSTree *t, CenteMove *moves, int *visits,
+                     int max) {
+  if (t->root < 0 || t->root >= t->used)
+    return 0;
+  const MCTSNode *rn = &t->nodes[t->root];
+  int n = rn->num_children < max ? rn->num_children : max;
+  for (int i = 0; i < n; i++) {
+    moves[i] = rn->actions[i];
+    visits[i] = rn->child_visits[i];
+  }
+  return n;
+}
+
+void mcts_last_stats(const MCTSTree *t, int *iterations, int *max_depth) {
+  *iterations = t->last_iters;
+  *max_depth = t->last_depth;
+}
+
+CenteMove mcts_select(const Board *root, int self_id, const InfluenceMap *inf,
+                      const cente_weights *w, const cente_mcts_params *params,
+                      int budget_ms) {
+  if (G_TREE &&
+      (G_TREE->width != root->width || G_TREE->height != root->height)) {
+    mcts_tree_destroy(G_TREE);
+    G_TREE = NULL;
+  }
+  if (!G_TREE)
+    G_TREE = mcts_tree_create(root->width, root->height, CENTE_MAX_NODES);
+  if (!G_TREE)
+    return (CenteMove){root->head_x[self_id], root->head_y[self_id]};
+  mcts_tree_set_root(G_TREE, root, self_id);
+  CenteBudget b = cente_budget_fixed(budget_ms);
+  return mcts_search(G_TREE, root, self_id, inf, w, params, &b, NULL);
 }
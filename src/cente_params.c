@@ -0,0 +1,140 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include "include/cente_params.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+  const char *name;
+  size_t offset; // into CenteParams
+  int is_int;
+  double lo, hi;
+  int tier;
+} ParamDesc;
+
+#define W_OFF(ph, f)                                                           \
+  (offsetof(CenteParams, phase) + (ph) * sizeof(cente_weights) +               \
+   offsetof(cente_weights, f))
+#define M_OFF(t, f)                                                            \
+  (offsetof(CenteParams, tier) + (t) * sizeof(cente_mcts_params) +             \
+   offsetof(cente_mcts_params, f))
+
+#define WEIGHTS(ph, pre)                                                       \
+  {pre ".alpha", W_OFF(ph, alpha), 0, 0.0, 1.0, -1},                           \
+  {pre ".beta", W_OFF(ph, beta), 0, 0.0, 1.0, -1},                             \
+  {pre ".gamma", W_OFF(ph, gamma), 0, 0.0, 1.0, -1},                           \
+  {pre ".delta", W_OFF(ph, delta), 0, 0.0, 1.0, -1},                           \
+  {pre ".eps", W_OFF(ph, eps), 0, 0.0, 1.0, -1},                               \
+  {pre ".zeta", W_OFF(ph, zeta), 0, 0.0, 1.0, -1}
+
+#define MCTS(t, pre)                                                           \
+  {pre ".c_puct", M_OFF(t, c_puct), 0, 0.1, 4.0, t},                           \
+  {pre ".k_base", M_OFF(t, k_base), 1, 2, CENTE_MAX_CHILDREN, t},              \
+  {pre ".k_inc", M_OFF(t, k_inc), 1, 0, 8, t},                                 \
+  {pre ".t1", M_OFF(t, t1), 1, 4, 256, t},                                     \
+  {pre ".t2", M_OFF(t, t2), 1, 8, 1024, t},                                    \
+  {pre ".t3", M_OFF(t, t3), 1, 16, 2048, t},                                   \
+  {pre ".rollout_depth", M_OFF(t, rollout_depth), 1, 1, 32, t},                \
+  {pre ".epsilon_rollout", M_OFF(t, epsilon_rollout), 0, 0.0, 1.0, t}
+
+static const ParamDesc PARAMS[] = {
+    WEIGHTS(0, "opening"), WEIGHTS(1, "midgame"), WEIGHTS(2, "endgame"),
+    MCTS(CENTE_SMALL, "small"), MCTS(CENTE_MEDIUM, "medium"),
+    MCTS(CENTE_LARGE, "large"),
+};
+
+#define NPARAMS ((int)(sizeof(PARAMS) / sizeof(PARAMS[0])))
+
+void cente_params_defaults(CenteParams *p) {
+  static const cente_weights phase[3] = {
+      {0.25f, 0.35f, 0.20f, 0.05f, 0.20f, 0.10f}, // opening
+      {0.30f, 0.25f, 0.20f, 0.10f, 0.20f, 0.15f}, // midgame
+      {0.30f, 0.15f, 0.10f, 0.25f, 0.10f, 0.25f}, // endgame
+  };
+  memcpy(p->phase, phase, sizeof(phase));
+  for (int t = 0; t < 3; t++)
+    p->tier[t] = cente_tier_mcts_defaults((cente_size_tier)t);
+}
+
+cente_size_params cente_params_for_size(const CenteParams *p, int width,
+                                        int height) {
+  cente_size_params sp = cente_defaults_for_size(width, height);
+  sp.mcts = p->tier[cente_select_size_tier(width, height)];
+  return sp;
+}
+
+int cente_params_count(void) { return NPARAMS; }
+
+const char *cente_params_name(int i) { return PARAMS[i].name; }
+
+void cente_params_range(int i, double *lo, double *hi) {
+  *lo = PARAMS[i].lo;
+  *hi = PARAMS[i].hi;
+}
+
+int cente_params_tier(int i) { return PARAMS[i].tier; }
+
+double cente_params_get(const CenteParams *p, int i) {
+  const char *base = (const char *)p + PARAMS[i].offset;
+  if (PARAMS[i].is_int)
+    return (double)*(const int *)(const void *)base;
+  return (double)*(const float *)(const void *)base;
+}
+
+void cente_params_put(CenteParams *p, int i, double v) {
+  if (v < PARAMS[i].lo)
+    v = PARAMS[i].lo;
+  if (v > PARAMS[i].hi)
+    v = PARAMS[i].hi;
+  char *base = (char *)p + PARAMS[i].offset;
+  if (PARAMS[i].is_int)
+    *(int *)(void *)base = (int)lround(v);
+  else
+    *(float *)(void *)base = (float)v;
+}
+
+int cente_params_load(const char *path, CenteParams *p) {
+  FILE *f = fopen(path, "r");
+  if (!f)
+    return -1;
+  char line[256];
+  int rc = 0;
+  while (rc == 0 && fgets(line, sizeof(line), f)) {
+    char *hash = strchr(line, '#');
+    if (hash)
+      *hash = '\0';
+    char name[64];
+    double v;
+    int got = sscanf(line, "%63s %lf", name, &v);
+    if (got <= 0)
+      continue; // blank or comment
+    rc = -1;
+    if (got != 2)
+      break;
+    for (int i = 0; i < NPARAMS; i++)
+      if (strcmp(name, PARAMS[i].name) == 0) {
+        cente_params_put(p, i, v);
+        rc = 0;
+        break;
+      }
+  }
+  fclose(f);
+  return rc;
+}
+
+int cente_params_save(const char *path, const CenteParams *p) {
+  FILE *f = fopen(path, "w");
+  if (!f)
+    return -1;
+  fprintf(f, "# cente engine parameters (CENTE_PARAMS=<file>)\n");
+  for (int i = 0; i < NPARAMS; i++) {
+    if (PARAMS[i].is_int)
+      fprintf(f, "%s %d\n", PARAMS[i].name, (int)cente_params_get(p, i));
+    else
+      fprintf(f, "%s %.6g\n", PARAMS[i].name, cente_params_get(p, i));
+  }
+  return fclose(f) == 0 ? 0 : -1;
+}
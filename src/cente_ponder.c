@@ -0,0 +1,80 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include "include/cente_ponder.h"
+#include <stdlib.h>
+#include <string.h>
+
+int ponder_init(CentePonder *pd, int width, int height) {
+  memset(pd, 0, sizeof(*pd));
+  int rc = board_init_storage(&pd->predicted, width, height);
+  pd->inf = influence_create(width, height);
+  if (rc != 0 || !pd->inf) {
+    ponder_destroy(pd);
+    return -1;
+  }
+  return 0;
+}
+
+void ponder_destroy(CentePonder *pd) {
+  ponder_stop(pd);
+  board_free_storage(&pd->predicted);
+  influence_destroy(pd->inf);
+  pd->inf = NULL;
+}
+
+static void *ponder_main(void *arg) {
+  CentePonder *pd = (CentePonder *)arg;
+  compute_influence_full(&pd->predicted, pd->self_id, pd->sigma, pd->inf);
+  CenteBudget budget = cente_budget_fixed(CENTE_PONDER_MAX_MS - pd->banked_ms);
+  mcts_search(pd->tree, &pd->predicted, pd->self_id, pd->inf, &pd->weights,
+              &pd->params, &budget, &pd->stop);
+  return NULL;
+}
+
+void ponder_start(CentePonder *pd, MCTSTree *tree, const Board *root,
+                  int self_id, CenteMove played, float sigma,
+                  const cente_weights *w, const cente_mcts_params *params) {
+  ponder_stop(pd);
+  if (!pd->predicted.cells || !pd->inf || !tree)
+    return;
+  mcts_tree_advance(tree, root, self_id, played, &pd->predicted);
+  if (pd->predicted.blocked[self_id])
+    return;
+  pd->tree = tree;
+  pd->self_id = self_id;
+  pd->sigma = sigma;
+  pd->weights = *w;
+  pd->params = *params;
+  pd->banked_ms = 0;
+  pd->stop = 0;
+  pd->started_ms = cente_now_ms();
+  if (pthread_create(&pd->thread, NULL, ponder_main, pd) == 0)
+    pd->running = 1;
+}
+
+int ponder_stop(CentePonder *pd) {
+  pd->paused = pd->running;
+  if (!pd->running)
+    return 0;
+  pd->stop = 1;
+  pthread_join(pd->thread, NULL);
+  pd->running = 0;
+  pd->banked_ms += (int)(cente_now_ms() - pd->started_ms);
+  return pd->banked_ms;
+}
+
+void ponder_resume(CentePonder *pd) {
+  if (!pd->paused || pd->running || pd->banked_ms >= CENTE_PONDER_MAX_MS)
+    return;
+  pd->paused = 0;
+  pd->stop = 0;
+  pd->started_ms = cente_now_ms();
+  if (pthread_create(&pd->thread, NULL, ponder_main, pd) == 0)
+    pd->running = 1;
+}
+
+void ponder_cancel(CentePonder *pd) {
+  ponder_stop(pd);
+  pd->paused = 0;
+  pd->banked_ms = 0;
+}
@@ -0,0 +1,116 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include "include/cente_rollout.h"
+#include <stdlib.h>
+
+// nbr[i*8 + d] = index of the neighbour of cell i in direction d, -1 if outside
+static int *g_nbr = NULL;
+static int g_w = 0, g_h = 0;
+
+void rollout_init(int width, int height) {
+  if (g_nbr && g_w == width && g_h == height)
+    return;
+  static const int dx[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+  static const int dy[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+  free(g_nbr);
+  size_t n = (size_t)width * (size_t)height;
+  g_nbr = (int *)malloc(n * 8 * sizeof(int));
+  if (!g_nbr) {
+    g_w = g_h = 0;
+    return;
+  }
+  g_w = width;
+  g_h = height;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      int *row = g_nbr + ((size_t)y * (size_t)width + (size_t)x) * 8;
+      for (int d = 0; d < 8; d++) {
+        int nx = x + dx[d], ny = y + dy[d];
+        row[d] = (nx >= 0 && nx < width && ny >= 0 && ny < height)
+                     ? ny * width + nx
+                     : -1;
+      }
+    }
+  }
+}
+
+// Epsilon-greedy step: random legal move with probability epsilon, otherwise
+// the one maximising cell value plus onward room. Returns -1 if stuck.
+static int policy_step(const Board *b, int p, float epsilon, CenteRng *rng) {
+  int w = b->width;
+  const int *cells = b->cells;
+  const int *nb = g_nbr + ((size_t)b->head_y[p] * (size_t)w + b->head_x[p]) * 8;
+  unsigned free8 = bits_free8(&b->bits, b->head_x[p], b->head_y[p]);
+  int legal[8];
+  int k = 0;
+  for (int d = 0; d < 8; d++)
+    if (free8 & (1u << d))
+      legal[k++] = nb[d];
+  if (k == 0)
+    return -1;
+  if (k == 1)
+    return legal[0];
+  if (cente_rng_float(rng) < epsilon)
+    return legal[cente_rng_next(rng) % (uint64_t)k];
+  int best = legal[0];
+  int best_s = -1;
+  for (int j = 0; j < k; j++) {
+    int c = legal[j];
+    // Value plus onward room (free cells around c)
+    int s = cells[c] + 3 * b->stats.free_nbr[c];
+    if (s > best_s) {
+      best_s = s;
+      best = c;
+    }
+  }
+  return best;
+}
+
+void rollout_predict_replies(Board *b, int self_id) {
+  if (!g_nbr || g_w != b->width || g_h != b->height)
+    return;
+  CenteRng unused;
+  cente_rng_seed(&unused, 1);
+  for (int k = 1; k < b->num_players; k++) {
+    int p = (self_id + k) % b->num_players;
+    if (b->blocked[p])
+      continue;
+    int c = policy_step(b, p, 0.0f, &unused);
+    if (c < 0) {
+      b->blocked[p] = 1;
+      continue;
+    }
+    board_apply_move(b, p, (CenteMove){c % b->width, c / b->width});
+  }
+}
+
+float rollout_run(Board *scratch, int self_id, const InfluenceMap *inf,
+                  const cente_weights *w, int depth, float epsilon,
+                  CenteRng *rng) {
+  if (!g_nbr || g_w != scratch->width || g_h != scratch->height)
+    return value_eval(scratch, self_id, inf, w);
+  int P = scratch->num_players;
+  int bw = scratch->width;
+  for (int ply = 0; ply < depth; ply++) {
+    int alive = 0;
+    for (int k = 1; k <= P; k++) {
+      int p = (self_id + k) % P;
+      if (scratch->blocked[p])
+        continue;
+      int c = policy_step(scratch, p, epsilon, rng);
+      if (c < 0) {
+        scratch->blocked[p] = 1;
+        if (p == self_id) {
+          // Walked into a dead end: the earlier, the worse
+          return 0.1f * (float)ply / (float)depth;
+        }
+        continue;
+      }
+      board_apply_move(scratch, p, (CenteMove){c % bw, c / bw});
+      alive++;
+    }
+    if (alive == 0)
+      break;
+  }
+  return value_eval(scratch, self_id, inf, w);
+}
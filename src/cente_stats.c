@@ -0,0 +1,49 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include "include/cente_stats.h"
+#include <stdlib.h>
+#include <string.h>
+
+FILE *cente_stats_open(void) {
+  const char *env = getenv("CENTE_STATS");
+  if (!env || !*env || strcmp(env, "0") == 0)
+    return NULL;
+  if (strcmp(env, "1") == 0 || strcmp(env, "stderr") == 0)
+    return stderr;
+  FILE *f = fopen(env, "a");
+  if (!f)
+    fprintf(stderr, "player_cente: cannot open stats file %s\n", env);
+  return f;
+}
+
+void cente_stats_close(FILE *f) {
+  if (f && f != stderr)
+    fclose(f);
+}
+
+void cente_stats_write(FILE *f, const CenteTurnStats *s) {
+  static const char *modes[] = {"book", "endgame", "mcts", "brs"};
+  if (!f)
+    return;
+  // Seats of a multi-seat player share the stream; keep each line whole
+  flockfile(f);
+  double nps =
+      s->search_ms > 0.0 ? (double)s->iterations * 1000.0 / s->search_ms : 0.0;
+  fprintf(f,
+          "{\"turn\":%d,\"player\":%d,\"mode\":\"%s\",\"sync_ms\":%.3f,"
+          "\"influence_ms\":%.3f,\"influence_builds\":%d,\"phase_ms\":%.3f,"
+          "\"autotune_ms\":%.3f,\"search_ms\":%.3f,\"total_ms\":%.3f,"
+          "\"soft_ms\":%d,\"hard_ms\":%d,\"pondered_ms\":%d,"
+          "\"iterations\":%ld,\"max_depth\":%d,\"nodes_per_sec\":%.0f,"
+          "\"root\":[",
+          s->turn, s->self_id, modes[s->mode], s->sync_ms, s->influence_ms,
+          s->influence_builds, s->phase_ms, s->autotune_ms, s->search_ms,
+          s->total_ms, s->soft_ms, s->hard_ms, s->pondered_ms, s->iterations,
+          s->max_depth, nps);
+  for (int i = 0; i < s->root_n; i++)
+    fprintf(f, "%s[%d,%d,%d]", i ? "," : "", s->root_moves[i].x,
+            s->root_moves[i].y, s->root_visits[i]);
+  fputs("]}\n", f);
+  fflush(f);
+  funlockfile(f);
+}
@@ -0,0 +1,141 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#ifdef __linux__
+#define _GNU_SOURCE // sched_getaffinity, CPU_COUNT
+#include <sched.h>
+#endif
+#include "include/cente_time.h"
+#include <time.h>
+#include <unistd.h>
+
+unsigned long long cente_now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000ULL +
+         (unsigned long long)(ts.tv_nsec / 1000000L);
+}
+
+unsigned long long cente_now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000ULL +
+         (unsigned long long)(ts.tv_nsec / 1000L);
+}
+
+int cente_usable_cpus(void) {
+#ifdef __linux__
+  cpu_set_t set;
+  if (sched_getaffinity(0, sizeof(set), &set) == 0 && CPU_COUNT(&set) > 0)
+    return CPU_COUNT(&set);
+#endif
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? (int)n : 1;
+}
+
+void search_clock_start(CenteSearchClock *c, const CenteBudget *b) {
+  c->start_ms = cente_now_ms();
+  c->deadline_ms = c->start_ms + (unsigned long long)b->soft_ms;
+  c->hard_ms = c->start_ms + (unsigned long long)(b->hard_ms > b->soft_ms
+                                                      ? b->hard_ms
+                                                      : b->soft_ms);
+  c->early_stop = b->early_stop;
+  c->extended = 0;
+  c->iters = 0;
+  c->next_check = 1;
+  c->check_every = 1;
+}
+
+int search_clock_done(CenteSearchClock *c, const int *child_visits, int n) {
+  if (++c->iters < c->next_check)
+    return 0;
+  unsigned long long now = cente_now_ms();
+  unsigned long long elapsed = now - c->start_ms;
+  // Read the clock about every quarter of a millisecond
+  float rate = elapsed > 0 ? (float)c->iters / (float)elapsed
+                           : (float)c->iters;
+  c->check_every = (int)(rate * 0.25f);
+  if (c->check_every < 1)
+    c->check_every = 1;
+  if (c->check_every > 256)
+    c->check_every = 256;
+  c->next_check = c->iters + c->check_every;
+
+  int best = 0, second = 0;
+  for (int i = 0; i < n; i++) {
+    if (child_visits[i] > best) {
+      second = best;
+      best = child_visits[i];
+    } else if (child_visits[i] > second) {
+      second = child_visits[i];
+    }
+  }
+  if (now + 1 >= c->deadline_ms) {
+    // Close race: spend the reserve once
+    if (c->early_stop && !c->extended && c->hard_ms > c->deadline_ms &&
+        (float)second >= CENTE_TIME_CLOSE * (float)best) {
+      c->extended = 1;
+      c->deadline_ms = c->hard_ms;
+      return 0;
+    }
+    return 1;
+  }
+  if (!c->early_stop)
+    return 0;
+  // A forced move needs no search
+  if (n < 2)
+    return 1;
+  // Iterations still to come cannot overturn the lead
+  float left = rate * (float)(c->deadline_ms - now);
+  return (float)(best - second) > left;
+}
+
+void turn_clock_init(CenteTurnClock *tc) {
+  tc->last_wake_ms = 0;
+  tc->cadence_ms = 0.0f;
+  tc->budget_ms = 0.0f;
+}
+
+void turn_clock_wake(CenteTurnClock *tc) {
+  unsigned long long now = cente_now_ms();
+  if (tc->last_wake_ms) {
+    float dt = (float)(now - tc->last_wake_ms);
+    // Posts that piled up while we were thinking wake us back to back
+    if (dt >= (float)CENTE_TIME_MIN_MS)
+      tc->cadence_ms = tc->cadence_ms > 0.0f
+                           ? 0.75f * tc->cadence_ms + 0.25f * dt
+                           : dt;
+  }
+  tc->last_wake_ms = now;
+}
+
+void turn_clock_feedback(CenteTurnClock *tc, int landed) {
+  if (tc->budget_ms <= 0.0f)
+    return;
+  // Additive-increase / multiplicative-decrease on missed turns
+  tc->budget_ms = landed ? tc->budget_ms * 1.1f + 1.0f : tc->budget_ms * 0.5f;
+  if (tc->budget_ms < (float)CENTE_TIME_MIN_MS)
+    tc->budget_ms = (float)CENTE_TIME_MIN_MS;
+}
+
+CenteBudget turn_clock_budget(CenteTurnClock *tc, int tier_ms) {
+  if (tc->budget_ms <= 0.0f)
+    tc->budget_ms = (float)tier_ms;
+  float cap = tc->cadence_ms > 0.0f ? CENTE_TIME_CADENCE_FRAC * tc->cadence_ms
+                                    : (float)tier_ms;
+  float hard_cap = tc->cadence_ms > 0.0f
+                       ? CENTE_TIME_HARD_FRAC * tc->cadence_ms
+                       : 1.5f * (float)tier_ms;
+  if (tc->budget_ms > cap)
+    tc->budget_ms = cap;
+  if (tc->budget_ms < (float)CENTE_TIME_MIN_MS)
+    tc->budget_ms = (float)CENTE_TIME_MIN_MS;
+  CenteBudget b;
+  b.soft_ms = (int)tc->budget_ms;
+  b.hard_ms = (int)(1.5f * tc->budget_ms);
+  if (b.hard_ms > (int)hard_cap)
+    b.hard_ms = (int)hard_cap;
+  if (b.hard_ms < b.soft_ms)
+    b.hard_ms = b.soft_ms;
+  b.early_stop = 1;
+  return b;
+}
@@ -0,0 +1,428 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+// Self-play tuner: plays seeded games between in-process engines on every
+// core (no master, no IPC, no tick delay), tunes CenteParams with SPSA and
+// checks the result against the starting point with an SPRT.
+#include "include/cente_engine.h"
+#include "include/cente_eval.h"
+#include "include/cente_kernels.h"
+#include "include/cente_params.h"
+#include "include/cente_rollout.h"
+#include "include/cente_zobrist.h"
+#include <getopt.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Verification games draw their boards away from the tuning games
+#define SPRT_SEEDS (1ULL << 40)
+
+typedef struct {
+  int width, height, players;
+  int move_ms; // search time per move
+} GameSpec;
+
+// One game: seats with group[s] == 0 play params[0], the rest params[1].
+// result: 1 if group 0 won, -1 if group 1 won, 0 on a draw.
+typedef struct {
+  uint64_t seed;
+  const CenteParams *params[2];
+  int swap; // group 0 takes the odd seats instead of the even ones
+  int result;
+} Job;
+
+typedef struct {
+  const GameSpec *spec;
+  Job *jobs;
+  int njobs;
+  int next;
+  pthread_mutex_t lock;
+} Batch;
+
+static uint64_t splitmix(uint64_t *s) {
+  uint64_t z = (*s += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+static const int DX[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+static const int DY[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+
+static int has_move(const int *cells, int w, int h, int x, int y) {
+  for (int d = 0; d < 8; d++) {
+    int nx = x + DX[d], ny = y + DY[d];
+    if (nx >= 0 && ny >= 0 && nx < w && ny < h && cells[ny * w + nx] > 0)
+      return 1;
+  }
+  return 0;
+}
+
+// Plays one game with the master's rules: every tick all live seats answer
+// the same snapshot, then the moves are applied in seat order
+static int play_game(CenteEngine **seats, int *cells, const GameSpec *gs,
+                     const Job *job) {
+  int w = gs->width, h = gs->height, P = gs->players;
+  unsigned short hx[CENTE_MAX_PLAYERS], hy[CENTE_MAX_PLAYERS];
+  unsigned char blocked[CENTE_MAX_PLAYERS] = {0};
+  unsigned int score[CENTE_MAX_PLAYERS] = {0};
+  unsigned int valid[CENTE_MAX_PLAYERS] = {0};
+  int group[CENTE_MAX_PLAYERS] = {0};
+  uint64_t rng = job->seed;
+  for (int i = 0; i < w * h; i++)
+    cells[i] = (int)(splitmix(&rng) % 9) + 1;
+  for (int p = 0; p < P; p++) {
+    int c;
+    do
+      c = (int)(splitmix(&rng) % (uint64_t)(w * h));
+    while (cells[c] <= 0);
+    hx[p] = (unsigned short)(c % w);
+    hy[p] = (unsigned short)(c / w);
+    cells[c] = -p;
+    group[p] = (p & 1) ^ job->swap;
+    seats[p]->params = *job->params[group[p]];
+    engine_reset(seats[p]);
+  }
+
+  CenteBudget budget = cente_budget_fixed(gs->move_ms);
+  CenteMove chosen[CENTE_MAX_PLAYERS];
+  for (int round = 0; round < w * h; round++) {
+    int live = 0;
+    for (int p = 0; p < P; p++) {
+      if (!blocked[p] && !has_move(cells, w, h, hx[p], hy[p]))
+        blocked[p] = 1;
+      live += !blocked[p];
+    }
+    if (!live)
+      break;
+    for (int p = 0; p < P; p++) {
+      if (blocked[p])
+        continue;
+      engine_sync(seats[p], P, hx, hy, blocked, score, valid, cells);
+      chosen[p] = engine_choose(seats[p], budget, 0);
+    }
+    for (int p = 0; p < P; p++) {
+      if (blocked[p])
+        continue;
+      int x = chosen[p].x, y = chosen[p].y;
+      int dx = x - hx[p], dy = y - hy[p];
+      if (x < 0 || y < 0 || x >= w || y >= h || dx < -1 || dx > 1 ||
+          dy < -1 || dy > 1 || cells[y * w + x] <= 0)
+        continue; // invalid, as the master would count it
+      score[p] += (unsigned int)cells[y * w + x];
+      cells[y * w + x] = -p;
+      hx[p] = (unsigned short)x;
+      hy[p] = (unsigned short)y;
+      valid[p]++;
+    }
+  }
+
+  // Same ranking as the master: score, then fewer valid moves
+  int best = 0;
+  for (int p = 1; p < P; p++)
+    if (score[p] > score[best] ||
+        (score[p] == score[best] && valid[p] < valid[best]))
+      best = p;
+  for (int p = 0; p < P; p++)
+    if (group[p] != group[best] && score[p] == score[best] &&
+        valid[p] == valid[best])
+      return 0;
+  return group[best] == 0 ? 1 : -1;
+}
+
+static void *worker_main(void *arg) {
+  Batch *bt = (Batch *)arg;
+  const GameSpec *gs = bt->spec;
+  CenteEngine *seats[CENTE_MAX_PLAYERS] = {NULL};
+  int *cells = (int *)malloc((size_t)gs->width * (size_t)gs->height *
+                             sizeof(int));
+  int ok = cells != NULL;
+  for (int p = 0; p < gs->players && ok; p++) {
+    seats[p] = engine_create(gs->width, gs->height, gs->players, p);
+    ok = seats[p] != NULL;
+    // Games run back to back, there is no opponent time to ponder in
+    if (ok && seats[p]->has_ponder) {
+      ponder_destroy(&seats[p]->ponder);
+      seats[p]->has_ponder = 0;
+    }
+  }
+  for (;;) {
+    pthread_mutex_lock(&bt->lock);
+    int j = bt->next < bt->njobs ? bt->next++ : -1;
+    pthread_mutex_unlock(&bt->lock);
+    if (j < 0)
+      break;
+    bt->jobs[j].result = ok ? play_game(seats, cells, gs, &bt->jobs[j]) : 0;
+  }
+  for (int p = 0; p < gs->players; p++)
+    engine_destroy(seats[p]);
+  free(cells);
+  return NULL;
+}
+
+static void run_batch(const GameSpec *gs, Job *jobs, int njobs, int threads) {
+  Batch bt = {gs, jobs, njobs, 0, PTHREAD_MUTEX_INITIALIZER};
+  pthread_t tid[256];
+  if (threads > njobs)
+    threads = njobs;
+  if (threads > 256)
+    threads = 256;
+  int started = 0;
+  for (; started < threads; started++)
+    if (pthread_create(&tid[started], NULL, worker_main, &bt) != 0)
+      break;
+  if (started == 0)
+    worker_main(&bt);
+  for (int i = 0; i < started; i++)
+    pthread_join(tid[i], NULL);
+}
+
+// Pairs of games on the same seed with the seats swapped; returns the sum of
+// the results from params a's side and adds the outcomes to wdl
+static int play_pairs(const GameSpec *gs, const CenteParams *a,
+                      const CenteParams *b, int pairs, uint64_t seed,
+                      int threads, int wdl[3]) {
+  Job *jobs = (Job *)calloc((size_t)pairs * 2, sizeof(Job));
+  if (!jobs)
+    return 0;
+  for (int i = 0; i < 2 * pairs; i++) {
+    jobs[i].seed = seed + (uint64_t)(i / 2);
+    jobs[i].params[0] = a;
+    jobs[i].params[1] = b;
+    jobs[i].swap = i & 1;
+  }
+  run_batch(gs, jobs, 2 * pairs, threads);
+  int sum = 0;
+  for (int i = 0; i < 2 * pairs; i++) {
+    sum += jobs[i].result;
+    if (wdl)
+      wdl[jobs[i].result > 0 ? 0 : (jobs[i].result == 0 ? 1 : 2)]++;
+  }
+  free(jobs);
+  return sum;
+}
+
+static double elo_score(double elo) {
+  return 1.0 / (1.0 + pow(10.0, -elo / 400.0));
+}
+
+// Trinomial GSPRT log-likelihood ratio of H1 (elo1) against H0 (elo0). Only
+// an empty or zero-variance sample gives 0: a side that never loses still
+// decides once draws or a single loss give the score some spread.
+static double sprt_llr(const int wdl[3], double elo0, double elo1) {
+  double n = wdl[0] + wdl[1] + wdl[2];
+  if (n == 0)
+    return 0.0;
+  double s = (wdl[0] + 0.5 * wdl[1]) / n;
+  double var = (wdl[0] * (1 - s) * (1 - s) + wdl[1] * (0.5 - s) * (0.5 - s) +
+                wdl[2] * s * s) /
+               n;
+  if (var <= 0)
+    return 0.0;
+  double s0 = elo_score(elo0), s1 = elo_score(elo1);
+  return n * (s1 - s0) * (2 * s - s0 - s1) / (2 * var);
+}
+
+typedef struct {
+  double elo0, elo1, alpha, beta;
+  int max_games;
+} SprtSpec;
+
+// Plays `test` against `base` until the SPRT decides: 1 accepts H1 (test is
+// at least elo1 stronger), -1 accepts H0, 0 ran out of games
+static int sprt_run(const GameSpec *gs, const CenteParams *test,
+                    const CenteParams *base, const SprtSpec *sp,
+                    uint64_t seed, int threads) {
+  double lower = log(sp->beta / (1 - sp->alpha));
+  double upper = log((1 - sp->beta) / sp->alpha);
+  int wdl[3] = {0, 0, 0};
+  int pairs = threads > 1 ? threads : 2;
+  double llr = 0.0;
+  int verdict = 0;
+  while (wdl[0] + wdl[1] + wdl[2] < sp->max_games) {
+    play_pairs(gs, test, base, pairs, seed, threads, wdl);
+    seed += (uint64_t)pairs;
+    llr = sprt_llr(wdl, sp->elo0, sp->elo1);
+    if (llr >= upper || llr <= lower) {
+      verdict = llr >= upper ? 1 : -1;
+      break;
+    }
+  }
+  printf("sprt: W %d D %d L %d llr %.2f [%.2f, %.2f] -> %s\n", wdl[0], wdl[1],
+         wdl[2], llr, lower, upper,
+         verdict > 0 ? "H1" : (verdict < 0 ? "H0" : "inconclusive"));
+  return verdict;
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [-w width] [-h height] [-p players] [-t ms] [-i iters] "
+          "[-g pairs] [-j threads] [-s seed] [-P start.params] [-o out] "
+          "[-k every] [-V]\n"
+          "  -t ms      search time per move (default 5)\n"
+          "  -i iters   SPSA iterations (default 100)\n"
+          "  -g pairs   seat-swapped game pairs per iteration (default 8)\n"
+          "  -k every   SPRT against the start every k iterations; stops on "
+          "H1 (default off)\n"
+          "  -V         SPRT the final parameters against the start\n"
+          "  -E e0,e1   SPRT elo bounds (default 0,10)\n"
+          "  -o out     parameter file to write (default cente.params)\n",
+          prog);
+}
+
+int main(int argc, char *argv[]) {
+  GameSpec gs = {10, 10, 2, 5};
+  int iters = 100, pairs = 8, every = 0, verify = 0;
+  int threads = cente_usable_cpus();
+  uint64_t seed = 1;
+  const char *start = NULL, *out = "cente.params";
+  SprtSpec sp = {0.0, 10.0, 0.05, 0.05, 4000};
+  int opt;
+  while ((opt = getopt(argc, argv, "w:h:p:t:i:g:j:s:P:o:k:VE:")) != -1) {
+    switch (opt) {
+    case 'w':
+      gs.width = atoi(optarg);
+      break;
+    case 'h':
+      gs.height = atoi(optarg);
+      break;
+    case 'p':
+      gs.players = atoi(optarg);
+      break;
+    case 't':
+      gs.move_ms = atoi(optarg);
+      break;
+    case 'i':
+      iters = atoi(optarg);
+      break;
+    case 'g':
+      pairs = atoi(optarg);
+      break;
+    case 'j':
+      threads = atoi(optarg);
+      break;
+    case 's':
+      seed = (uint64_t)strtoull(optarg, NULL, 10);
+      break;
+    case 'P':
+      start = optarg;
+      break;
+    case 'o':
+      out = optarg;
+      break;
+    case 'k':
+      every = atoi(optarg);
+      break;
+    case 'V':
+      verify = 1;
+      break;
+    case 'E':
+      if (sscanf(optarg, "%lf,%lf", &sp.elo0, &sp.elo1) != 2) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+      }
+      break;
+    default:
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (gs.width < 2 || gs.height < 2 || gs.players < 2 ||
+      gs.players > CENTE_MAX_PLAYERS || gs.width * gs.height < gs.players ||
+      gs.move_ms < 1 || iters < 0 || pairs < 1) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (threads < 1)
+    threads = 1;
+
+  CenteParams base;
+  cente_params_defaults(&base);
+  if (start && cente_params_load(start, &base) != 0) {
+    fprintf(stderr, "cente_tune: cannot load %s\n", start);
+    return EXIT_FAILURE;
+  }
+  // Shared tables are built once here; workers only read them
+  zobrist_init(gs.width, gs.height, gs.players);
+  kernels_init(gs.width, gs.height);
+  eval_init(gs.width, gs.height);
+  rollout_init(gs.width, gs.height);
+
+  // SPSA over the phase weights and this board's tier, in units of each
+  // parameter's range
+  int tier = (int)cente_select_size_tier(gs.width, gs.height);
+  int n = cente_params_count();
+  int *active = (int *)malloc((size_t)n * sizeof(int));
+  double *theta = (double *)malloc((size_t)n * sizeof(double));
+  double *delta = (double *)malloc((size_t)n * sizeof(double));
+  if (!active || !theta || !delta) {
+    fprintf(stderr, "cente_tune: out of memory\n");
+    return EXIT_FAILURE;
+  }
+  int d = 0;
+  for (int i = 0; i < n; i++) {
+    int t = cente_params_tier(i);
+    if (t != -1 && t != tier)
+      continue;
+    double lo, hi;
+    cente_params_range(i, &lo, &hi);
+    active[d] = i;
+    theta[d] = (cente_params_get(&base, i) - lo) / (hi - lo);
+    d++;
+  }
+
+  // Gains: c perturbs by 5% of each range, a keeps early steps to a few %
+  const double a = 0.01, c = 0.05, alpha = 0.602, gamma = 0.101;
+  const double A = 0.1 * iters;
+  CenteParams cur = base, plus, minus;
+  uint64_t rng = seed ^ 0x5851f42d4c957f2dULL;
+  uint64_t game_seed = seed;
+  printf("cente_tune: %dx%d, %d players, %d ms/move, %d params, %d threads\n",
+         gs.width, gs.height, gs.players, gs.move_ms, d, threads);
+  for (int k = 0; k < iters; k++) {
+    double ak = a / pow(k + 1 + A, alpha);
+    double ck = c / pow(k + 1, gamma);
+    plus = cur;
+    minus = cur;
+    for (int j = 0; j < d; j++) {
+      double lo, hi;
+      cente_params_range(active[j], &lo, &hi);
+      delta[j] = (splitmix(&rng) & 1) ? 1.0 : -1.0;
+      double step = ck * delta[j];
+      cente_params_put(&plus, active[j], lo + (theta[j] + step) * (hi - lo));
+      cente_params_put(&minus, active[j], lo + (theta[j] - step) * (hi - lo));
+    }
+    int sum = play_pairs(&gs, &plus, &minus, pairs, game_seed, threads, NULL);
+    game_seed += (uint64_t)pairs;
+    double r = (double)sum / (2.0 * pairs);
+    for (int j = 0; j < d; j++) {
+      double lo, hi;
+      cente_params_range(active[j], &lo, &hi);
+      theta[j] += ak * r / (2.0 * ck * delta[j]);
+      theta[j] = theta[j] < 0.0 ? 0.0 : (theta[j] > 1.0 ? 1.0 : theta[j]);
+      cente_params_put(&cur, active[j], lo + theta[j] * (hi - lo));
+    }
+    printf("iter %d/%d: plus-minus %+.3f\n", k + 1, iters, r);
+    fflush(stdout);
+    if (every > 0 && (k + 1) % every == 0 &&
+        sprt_run(&gs, &cur, &base, &sp, SPRT_SEEDS + game_seed, threads) > 0) {
+      printf("cente_tune: SPRT accepted after %d iterations\n", k + 1);
+      break;
+    }
+  }
+  if (verify)
+    sprt_run(&gs, &cur, &base, &sp, SPRT_SEEDS + game_seed, threads);
+
+  int rc = cente_params_save(out, &cur);
+  if (rc != 0)
+    perror("cente_tune");
+  else
+    printf("cente_tune: wrote %s\n", out);
+  free(active);
+  free(theta);
+  free(delta);
+  return rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
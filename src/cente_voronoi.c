@@ -0,0 +1,120 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include "include/cente_voronoi.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct VoronoiScratch {
+  size_t words; // per mask: height * row words
+  uint64_t *front[CENTE_MAX_PLAYERS];
+  uint64_t *next;   // dilation output
+  uint64_t *seen;   // claimed or contested so far
+  uint64_t *step;   // reached by anyone this step
+  uint64_t *twice;  // reached by two or more this step
+  uint64_t *owned[CENTE_MAX_PLAYERS];
+  uint64_t *block;  // single allocation backing every mask
+};
+
+VoronoiScratch *voronoi_create(int width, int height) {
+  VoronoiScratch *s = (VoronoiScratch *)calloc(1, sizeof(VoronoiScratch));
+  if (!s)
+    return NULL;
+  s->words = (size_t)height * (size_t)((width + 63) / 64);
+  size_t masks = 2 * CENTE_MAX_PLAYERS + 4;
+  s->block = (uint64_t *)malloc(masks * s->words * sizeof(uint64_t));
+  if (!s->block) {
+    free(s);
+    return NULL;
+  }
+  uint64_t *p = s->block;
+  for (int i = 0; i < CENTE_MAX_PLAYERS; i++) {
+    s->front[i] = p;
+    p += s->words;
+    s->owned[i] = p;
+    p += s->words;
+  }
+  s->next = p;
+  s->seen = p + s->words;
+  s->step = p + 2 * s->words;
+  s->twice = p + 3 * s->words;
+  return s;
+}
+
+void voronoi_destroy(VoronoiScratch *s) {
+  if (!s)
+    return;
+  free(s->block);
+  free(s);
+}
+
+static long long mask_value(const Board *b, const uint64_t *m, size_t words) {
+  int rw = b->bits.words;
+  long long v = 0;
+  for (size_t i = 0; i < words; i++) {
+    uint64_t bits = m[i];
+    int y = (int)(i / (size_t)rw);
+    int x0 = (int)(i % (size_t)rw) * 64;
+    const int *row = b->cells + (size_t)y * (size_t)b->width;
+    while (bits) {
+      v += row[x0 + __builtin_ctzll(bits)];
+      bits &= bits - 1;
+    }
+  }
+  return v;
+}
+
+void voronoi_eval(Board *b, VoronoiScratch *s, VoronoiResult *out) {
+  int P = b->num_players;
+  size_t nw = s->words, bytes = nw * sizeof(uint64_t);
+  int live[CENTE_MAX_PLAYERS];
+  int nl = 0;
+  memset(out, 0, sizeof(*out));
+  memset(s->seen, 0, bytes);
+  for (int p = 0; p < P; p++) {
+    memset(s->owned[p], 0, bytes);
+    if (b->blocked[p])
+      continue;
+    memset(s->front[p], 0, bytes);
+    bits_set(&b->bits, s->front[p], b->head_x[p], b->head_y[p]);
+    live[nl++] = p;
+  }
+
+  while (nl > 0) {
+    memset(s->step, 0, bytes);
+    memset(s->twice, 0, bytes);
+    // Grow every front into unclaimed free cells, noting collisions
+    for (int k = 0; k < nl; k++) {
+      uint64_t *f = s->front[live[k]];
+      bits_expand_free(&b->bits, f, s->next);
+      for (size_t i = 0; i < nw; i++) {
+        uint64_t v = s->next[i] & ~s->seen[i];
+        f[i] = v;
+        s->twice[i] |= s->step[i] & v;
+        s->step[i] |= v;
+      }
+    }
+    // Contested cells go to nobody but keep propagating, so ownership
+    // matches comparing independent BFS distances; empty fronts stop
+    int alive = 0;
+    for (int k = 0; k < nl; k++) {
+      int p = live[k];
+      uint64_t *f = s->front[p], any = 0;
+      for (size_t i = 0; i < nw; i++) {
+        s->owned[p][i] |= f[i] & ~s->twice[i];
+        any |= f[i];
+      }
+      if (any)
+        live[alive++] = p;
+    }
+    for (size_t i = 0; i < nw; i++)
+      s->seen[i] |= s->step[i];
+    nl = alive;
+  }
+
+  for (int p = 0; p < P; p++) {
+    if (b->blocked[p])
+      continue;
+    out->count[p] = bits_count(&b->bits, s->owned[p]);
+    out->value[p] = mask_value(b, s->owned[p], nw);
+  }
+}
@@ -62,3 +62,27 @@ uint64_t zobrist_hash_board(const Board *b) {
   h ^= (uint64_t)b->current_player * 0x9e3779b97f4a7c15ULL;
   return h;
 }
+
+uint64_t zobrist_hash_sym(const Board *b, int sym) {
+  int w = b->width, h = b->height;
+  size_t n = (size_t)w * (size_t)h;
+  uint64_t hs = 0;
+  if (!cell_keys || !head_keys)
+    return hs;
+  int tx, ty;
+  for (int y = 0; y < h; y++) {
+    const int *row = b->cells + (size_t)y * (size_t)w;
+    for (int x = 0; x < w; x++) {
+      if (row[x] > 0)
+        continue;
+      zobrist_sym_point(sym, w, h, x, y, &tx, &ty);
+      hs ^= cell_keys[(size_t)ty * (size_t)w + (size_t)tx];
+    }
+  }
+  for (int p = 0; p < b->num_players; p++) {
+    zobrist_sym_point(sym, w, h, b->head_x[p], b->head_y[p], &tx, &ty);
+    hs ^= head_keys[p * n + (size_t)ty * (size_t)w + (size_t)tx];
+  }
+  hs ^= (uint64_t)b->current_player * 0x9e3779b97f4a7c15ULL;
+  return hs;
+}
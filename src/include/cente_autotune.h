@@ -7,7 +7,7 @@
 #include "cente_config.h"
 
 // Computes dynamic parameters based on board size, density, mobility and tempo.
-// Inputs: base size params from cente_defaults_for_size, detected phase, influence map.
+// Inputs: base size params from cente_params_for_size, detected phase, influence map.
 // Output: tuned params (out), and returns a tempo_proxy in [0,1].
 float cente_autotune(const Board *b, int self_id, const InfluenceMap *inf,
                      cente_phase phase,
@@ -0,0 +1,57 @@
+#ifndef CENTE_BITBOARD_H
+#define CENTE_BITBOARD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Bit-per-cell view of the grid, kept next to Board.cells. Each row takes
+// `words` 64-bit words (bit x of the row is column x); the padding bits past
+// the last column are permanently set in `occ` so ~occ is exactly the free
+// cells of the board.
+typedef struct {
+    int width;
+    int height;
+    int words;       // (width + 63) / 64
+    uint64_t *occ;   // height * words, cells <= 0
+    uint64_t *heads; // height * words, current head cells
+    uint64_t *tmp;   // 3 * words, dilation rows
+} BoardBits;
+
+int bits_init(BoardBits *bb, int width, int height);
+void bits_free(BoardBits *bb);
+void bits_copy(BoardBits *dst, const BoardBits *src);
+
+// Rebuilds occ from the cells; heads are cleared
+void bits_rebuild(BoardBits *bb, const int *cells);
+
+static inline uint64_t *bits_row(const BoardBits *bb, const uint64_t *m, int y) {
+    return (uint64_t *)m + (size_t)y * (size_t)bb->words;
+}
+static inline void bits_set(const BoardBits *bb, uint64_t *m, int x, int y) {
+    bits_row(bb, m, y)[x >> 6] |= 1ULL << (x & 63);
+}
+static inline void bits_clear(const BoardBits *bb, uint64_t *m, int x, int y) {
+    bits_row(bb, m, y)[x >> 6] &= ~(1ULL << (x & 63));
+}
+static inline int bits_test(const BoardBits *bb, const uint64_t *m, int x, int y) {
+    return (int)((bits_row(bb, m, y)[x >> 6] >> (x & 63)) & 1ULL);
+}
+
+// Free neighbours of (x,y) as an 8-bit mask, bit d set when direction d
+// (N, NE, E, SE, S, SW, W, NW, the order used for moves) is inside the board
+// and free. Three 3-bit row windows, no per-cell probes.
+unsigned bits_free8(const BoardBits *bb, int x, int y);
+
+static inline int bits_mobility(const BoardBits *bb, int x, int y) {
+    return __builtin_popcount(bits_free8(bb, x, y));
+}
+
+// dst = (src dilated by one cell in all 8 directions) & free. One step of a
+// flood fill or multi-source BFS over whole words. src and dst must differ;
+// src must have no bits in the row padding.
+void bits_expand_free(BoardBits *bb, const uint64_t *src, uint64_t *dst);
+
+// Number of set bits in a height * words mask
+int bits_count(const BoardBits *bb, const uint64_t *m);
+
+#endif
@@ -3,11 +3,20 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "cente_bitboard.h"
 
 #define CENTE_MAX_PLAYERS 9
 
 typedef struct { int x, y; } CenteMove;
 
+// Aggregates kept in step with the cells by board_apply_move, so phase
+// detection, autotune and eval read them in O(1)
+typedef struct {
+    int occupied;            // cells <= 0
+    long long free_value;    // sum of the values of the free cells
+    unsigned char *free_nbr; // per cell: free cells among its 8 neighbours
+} BoardStats;
+
 typedef struct {
     int width;
     int height;
@@ -21,6 +30,8 @@ typedef struct {
 
     // Grid encoding: >0 free points; <=0 occupied by body or head (-pid)
     int *cells; // size width*height
+    BoardStats stats;
+    BoardBits bits; // occupancy/head bitboards mirroring cells
 } Board;
 
 Board *board_create_from_shared(int width, int height,
@@ -34,11 +45,31 @@ Board *board_create_from_shared(int width, int height,
 
 void board_destroy(Board *b);
 
+// For boards embedded in other structs: allocate/free cells and stats for a
+// width x height grid. board_copy_into needs dst set up this way.
+int board_init_storage(Board *b, int width, int height);
+void board_free_storage(Board *b);
+void board_copy_into(Board *dst, const Board *src);
+
+// Recomputes the stats and bitboards from the cells and heads (after
+// overwriting them wholesale)
+void board_stats_rebuild(Board *b);
+
+// Moves the head of player_id to (x,y) without touching the cells
+void board_set_head(Board *b, int player_id, int x, int y);
+
+// Marks cell i as occupied with `value` (<= 0), keeping the stats in step
+void board_occupy(Board *b, int i, int value);
+
 bool board_is_inside(const Board *b, int x, int y);
 bool board_is_legal(const Board *b, int player_id, CenteMove m);
 int  board_legal_moves(const Board *b, int player_id, CenteMove out[], int max_out);
 
 void board_apply_move(Board *b, int player_id, CenteMove m);
+// Takes back board_apply_move(b, player_id, m): the head returns to
+// (from_x, from_y) and the destination gets dest_value back
+void board_undo_move(Board *b, int player_id, int from_x, int from_y,
+                     int dest_value);
 uint64_t board_hash(const Board *b);
 
 #endif
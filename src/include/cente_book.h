@@ -0,0 +1,61 @@
+#ifndef CENTE_BOOK_H
+#define CENTE_BOOK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cente_board.h"
+
+// Opening book file: a header followed by entries sorted by key. Keys are
+// the smallest, over the board's symmetries, of zobrist_hash_sym (with
+// current_player set to the side to move) mixed with the values of the free
+// cells within value_radius of a head; moves are stored as a direction 0..7
+// in that canonical frame. The file is mapped read-only as is,
+// so the layout is that of the host that built it.
+#define CENTE_BOOK_MAGIC "CENTEBK2"
+
+typedef struct {
+    char magic[8];
+    uint32_t width;
+    uint32_t height;
+    uint32_t players;
+    uint32_t max_occupied; // no entry has more occupied cells than this
+    uint32_t value_radius; // CENTE_BOOK_VALUE_RADIUS of the builder
+    uint32_t pad;
+    uint64_t count;
+} CenteBookHeader;
+
+typedef struct {
+    uint64_t key;
+    uint32_t weight; // root visits behind the move, summed over searches
+    uint8_t dir;     // canonical direction
+    uint8_t pad[3];
+} CenteBookEntry;
+
+typedef struct CenteBook CenteBook;
+
+// Maps `path` and checks it was built for this board size and player count
+// (and with the same CENTE_BOOK_VALUE_RADIUS).
+// Returns NULL (quietly) when the file is missing or does not match.
+CenteBook *book_open(const char *path, int width, int height, int players);
+// $CENTE_BOOK, else CENTE_BOOK_DIR/cente_<w>x<h>_<players>.book; NULL on
+// boards larger than CENTE_BOOK_MAX_AREA
+CenteBook *book_open_default(int width, int height, int players);
+void book_close(CenteBook *book);
+
+// Canonical key of b (current_player must be the side to move) and the
+// symmetry that produces it
+uint64_t book_key(const Board *b, int *sym);
+// Direction d mapped into / back out of the frame of symmetry sym
+int book_dir_to_canon(int sym, int dir);
+int book_dir_from_canon(int sym, int dir);
+
+// Binary search for the position with self_id to move. Returns 1 and the
+// move when the book has a legal one. Does not allocate.
+int book_probe(const CenteBook *book, const Board *b, int self_id,
+               CenteMove *out);
+
+// Sorts `entries` by key and writes a book file; keys must be unique
+int book_write(const char *path, int width, int height, int players,
+               int max_occupied, CenteBookEntry *entries, size_t count);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef CENTE_BRS_H
+#define CENTE_BRS_H
+
+#include "cente_board.h"
+#include "cente_config.h"
+#include "cente_eval.h"
+#include "cente_influence.h"
+#include "cente_time.h"
+
+// Best-reply search: alpha-beta over layers that alternate between our move
+// and a single reply from whichever opponent hurts us most (the others stand
+// still). Branching stays near 8 * replies however many heads there are, so
+// collisions and cut-offs a few moves deep are seen within the turn budget.
+typedef struct CenteBrs CenteBrs;
+
+CenteBrs *brs_create(int width, int height);
+void brs_destroy(CenteBrs *s);
+
+// Iterative deepening from `root` until the budget's soft limit (never past
+// the hard one). Leaves score value_eval blended with the Voronoi share, as
+// the MCTS playouts do. Returns the head position if self_id cannot move.
+CenteMove brs_search(CenteBrs *s, const Board *root, int self_id,
+                     const InfluenceMap *inf, const cente_weights *w,
+                     const CenteBudget *budget);
+
+// Depth reached and nodes visited by the last search
+int brs_last_depth(const CenteBrs *s);
+long brs_last_nodes(const CenteBrs *s);
+
+#endif
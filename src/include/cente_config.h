@@ -11,6 +11,131 @@
 #define TT_SIZE_MB 32
 #endif
 
+// Search during opponents' turns (0 disables the background thread)
+#ifndef CENTE_PONDER
+#define CENTE_PONDER 1
+#endif
+
+// Upper bound for a single pondering session, in case the master stalls
+#ifndef CENTE_PONDER_MAX_MS
+#define CENTE_PONDER_MAX_MS 2000
+#endif
+
+// Gaussian used for the influence maps: CENTE_BLUR_FIR (truncated kernel,
+// cost grows with sigma), CENTE_BLUR_IIR (recursive, cost independent of
+// sigma) or CENTE_BLUR_AUTO (IIR once the kernel radius exceeds
+// CENTE_BLUR_IIR_RADIUS). The CENTE_BLUR environment variable ("fir", "iir",
+// "auto") overrides it at run time.
+#define CENTE_BLUR_FIR 0
+#define CENTE_BLUR_IIR 1
+#define CENTE_BLUR_AUTO 2
+
+#ifndef CENTE_BLUR_MODE
+#define CENTE_BLUR_MODE CENTE_BLUR_AUTO
+#endif
+
+#ifndef CENTE_BLUR_IIR_RADIUS
+#define CENTE_BLUR_IIR_RADIUS 16
+#endif
+
+// Boards with at least this many cells keep their influence maps as 16-bit
+// fixed point (half the memory traffic of float once they outgrow L2). The
+// CENTE_INF_COMPACT environment variable ("0", "1") overrides it.
+#ifndef CENTE_INF_COMPACT_CELLS
+#define CENTE_INF_COMPACT_CELLS 250000
+#endif
+
+// Weight of the Voronoi territory share in the MCTS leaf value (the rest is
+// the rollout evaluation); 0 skips the BFS
+#ifndef CENTE_VORONOI_WEIGHT
+#define CENTE_VORONOI_WEIGHT 0.5f
+#endif
+
+// Time manager: never think for less than CENTE_TIME_MIN_MS, at most
+// CENTE_TIME_CADENCE_FRAC of the master's turn interval (CENTE_TIME_HARD_FRAC
+// with extensions), and extend when the runner-up has at least
+// CENTE_TIME_CLOSE of the best move's visits
+#ifndef CENTE_TIME_MIN_MS
+#define CENTE_TIME_MIN_MS 5
+#endif
+
+#ifndef CENTE_TIME_CADENCE_FRAC
+#define CENTE_TIME_CADENCE_FRAC 0.5f
+#endif
+
+#ifndef CENTE_TIME_HARD_FRAC
+#define CENTE_TIME_HARD_FRAC 0.8f
+#endif
+
+#ifndef CENTE_TIME_CLOSE
+#define CENTE_TIME_CLOSE 0.85f
+#endif
+
+// Opening book: looked up while at most max_occupied cells are taken (as
+// recorded by the builder), only on boards up to CENTE_BOOK_MAX_AREA cells.
+// The CENTE_BOOK environment variable names the file; otherwise
+// CENTE_BOOK_DIR/cente_<w>x<h>_<players>.book is tried.
+#ifndef CENTE_BOOK_MAX_AREA
+#define CENTE_BOOK_MAX_AREA 300
+#endif
+
+#ifndef CENTE_BOOK_DIR
+#define CENTE_BOOK_DIR "books"
+#endif
+
+// Book keys also hash the values of the free cells within this many steps
+// (Chebyshev) of any head, so a book move is only replayed where the nearby
+// values match the board it was searched on
+#ifndef CENTE_BOOK_VALUE_RADIUS
+#define CENTE_BOOK_VALUE_RADIUS 2
+#endif
+
+// Endgame: once no live rival can reach our region it is toured without
+// search. Regions up to CENTE_ENDGAME_EXACT cells (at most 64) are solved
+// exactly, giving up after CENTE_ENDGAME_NODES nodes with the best tour so
+// far; larger ones get a greedy tour.
+#ifndef CENTE_ENDGAME_EXACT
+#define CENTE_ENDGAME_EXACT 40
+#endif
+
+#ifndef CENTE_ENDGAME_NODES
+#define CENTE_ENDGAME_NODES 500000
+#endif
+
+// Search engine: CENTE_SEARCH_MCTS, CENTE_SEARCH_BRS (best-reply alpha-beta,
+// see cente_brs.h) or CENTE_SEARCH_AUTO (BRS while a live rival head is
+// within CENTE_BRS_NEAR cells of ours, MCTS otherwise). The CENTE_SEARCH
+// environment variable ("mcts", "brs", "auto") overrides it at run time.
+// MCTS stays the default until a cente_tune SPRT shows AUTO at least as
+// strong.
+#define CENTE_SEARCH_MCTS 0
+#define CENTE_SEARCH_BRS 1
+#define CENTE_SEARCH_AUTO 2
+
+#ifndef CENTE_SEARCH_MODE
+#define CENTE_SEARCH_MODE CENTE_SEARCH_MCTS
+#endif
+
+#ifndef CENTE_BRS_NEAR
+#define CENTE_BRS_NEAR 3
+#endif
+
+// Best-reply search: replies expanded per opponent layer (the most
+// dangerous first) and the iterative deepening limit in plies
+#ifndef CENTE_BRS_REPLIES
+#define CENTE_BRS_REPLIES 16
+#endif
+
+#ifndef CENTE_BRS_MAX_DEPTH
+#define CENTE_BRS_MAX_DEPTH 32
+#endif
+
+// Multi-seat player (master -g): searches running at once across the seats
+// of one process; 0 means one per CPU in its affinity mask
+#ifndef CENTE_SEAT_THREADS
+#define CENTE_SEAT_THREADS 0
+#endif
+
 #ifndef KERNEL_SIGMA_FACTOR
 #define KERNEL_SIGMA_FACTOR 6
 #endif
@@ -51,37 +176,43 @@ static inline cente_size_tier cente_select_size_tier(int width, int height) {
     return CENTE_LARGE; // 19x19+
 }
 
-static inline cente_size_params cente_defaults_for_size(int width, int height) {
-    cente_size_tier tier = cente_select_size_tier(width, height);
-    cente_size_params p;
+// Built-in search parameters of a tier (see cente_params.h for overrides).
+// A node has at most 8 moves: k_base admits the best few by the cheap
+// ordering and k_inc at t1/t2/t3 lets a busy node reach all of them.
+static inline cente_mcts_params cente_tier_mcts_defaults(cente_size_tier tier) {
+    cente_mcts_params m;
     if (tier == CENTE_SMALL) {
-        p.budget_ms = 25;
-        p.sigma = (float)((width < height ? width : height) / (float)KERNEL_SIGMA_FACTOR);
-        p.mcts.c_puct = 0.8f;
-        p.mcts.k_base = 12;
-        p.mcts.k_inc = 4;
-        p.mcts.t1 = 32; p.mcts.t2 = 96; p.mcts.t3 = 192;
-        p.mcts.rollout_depth = 6;
-        p.mcts.epsilon_rollout = 0.15f;
+        m.c_puct = 0.8f;
+        m.k_base = 5;
+        m.k_inc = 2;
+        m.t1 = 32; m.t2 = 96; m.t3 = 192;
+        m.rollout_depth = 6;
+        m.epsilon_rollout = 0.15f;
     } else if (tier == CENTE_MEDIUM) {
-        p.budget_ms = 80;
-        p.sigma = (float)((width < height ? width : height) / (float)KERNEL_SIGMA_FACTOR);
-        p.mcts.c_puct = 1.2f;
-        p.mcts.k_base = 10;
-        p.mcts.k_inc = 3;
-        p.mcts.t1 = 48; p.mcts.t2 = 144; p.mcts.t3 = 384;
-        p.mcts.rollout_depth = 8;
-        p.mcts.epsilon_rollout = 0.20f;
+        m.c_puct = 1.2f;
+        m.k_base = 4;
+        m.k_inc = 2;
+        m.t1 = 48; m.t2 = 144; m.t3 = 384;
+        m.rollout_depth = 8;
+        m.epsilon_rollout = 0.20f;
     } else {
-        p.budget_ms = 250;
-        p.sigma = (float)((width < height ? width : height) / (float)KERNEL_SIGMA_FACTOR);
-        p.mcts.c_puct = 1.6f;
-        p.mcts.k_base = 8;
-        p.mcts.k_inc = 2;
-        p.mcts.t1 = 64; p.mcts.t2 = 192; p.mcts.t3 = 512;
-        p.mcts.rollout_depth = 10;
-        p.mcts.epsilon_rollout = 0.25f;
+        m.c_puct = 1.6f;
+        m.k_base = 3;
+        m.k_inc = 2;
+        m.t1 = 64; m.t2 = 192; m.t3 = 512;
+        m.rollout_depth = 10;
+        m.epsilon_rollout = 0.25f;
     }
+    return m;
+}
+
+static inline cente_size_params cente_defaults_for_size(int width, int height) {
+    static const int budget_ms[3] = {25, 80, 250};
+    cente_size_tier tier = cente_select_size_tier(width, height);
+    cente_size_params p;
+    p.budget_ms = budget_ms[tier];
+    p.sigma = (float)((width < height ? width : height) / (float)KERNEL_SIGMA_FACTOR);
+    p.mcts = cente_tier_mcts_defaults(tier);
     if (p.sigma < 1.0f) p.sigma = 1.0f;
     return p;
 }
@@ -0,0 +1,50 @@
+#ifndef CENTE_CONVOLVE_H
+#define CENTE_CONVOLVE_H
+
+#include <stddef.h>
+
+// Largest difference allowed between the vectorised path and
+// convolve_reference, relative to the peak of the input (FMA and summation
+// order change the rounding, nothing else).
+#define CENTE_CONVOLVE_TOLERANCE 1e-5f
+
+// Floats of scratch convolve_separable2 needs for a w x h map and radius r
+size_t convolve_scratch_floats(int w, int h, int r);
+
+// Convolves two maps with the same normalised 1D kernel (2r+1 taps),
+// horizontally then vertically, replicating the border cells. Both maps are
+// processed in one fused pass; each pass works on whole border-padded planes.
+void convolve_separable2(const float *src_a, const float *src_b, float *dst_a,
+                         float *dst_b, int w, int h, const float *k, int r,
+                         float *scratch);
+
+// Scalar single-map version with per-tap clamping, kept as the reference
+void convolve_reference(const float *src, float *tmp, float *dst, int w, int h,
+                        const float *k, int r);
+
+// y[i] += k * x[i], through the same runtime-selected backend
+void convolve_axpy(float *y, const float *x, float k, int n);
+
+// Recursive (IIR) Gaussian, cost per sample independent of sigma
+// (valid for sigma >= 0.5). Tracks the FIR result to ~1.5% of the peak.
+typedef struct {
+    double B, c1, c2, c3;
+    int pad; // replicated samples appended past the border
+    float sigma;
+} CenteIIR;
+
+void convolve_iir_setup(CenteIIR *f, float sigma);
+
+// Doubles of scratch convolve_iir_impulse needs for a line of len samples
+size_t convolve_iir_scratch(const CenteIIR *f, int len);
+
+// Response of a len-sample line with replicated borders to a unit impulse
+// at s, forward and backward recursive passes
+void convolve_iir_impulse(const CenteIIR *f, int len, int s, float *out,
+                          double *scratch);
+
+// Name of the backend picked at runtime ("avx2", "sse2", "neon", "scalar")
+const char *convolve_backend(void);
+
+#endif
+
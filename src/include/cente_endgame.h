@@ -0,0 +1,33 @@
+#ifndef CENTE_ENDGAME_H
+#define CENTE_ENDGAME_H
+
+#include "cente_board.h"
+#include "cente_config.h"
+
+// Free cells 8-connected to a player's head
+typedef struct {
+    int size;
+    long long value;
+    int isolated; // no other live head is next to any of its cells
+} CenteRegion;
+
+typedef struct CenteEndgame CenteEndgame;
+
+CenteEndgame *endgame_create(int width, int height);
+void endgame_destroy(CenteEndgame *eg);
+
+// Flood fill from self_id's head
+void endgame_region(CenteEndgame *eg, const Board *b, int self_id,
+                    CenteRegion *out);
+
+// When self_id's region is isolated, returns 1 and the next step of a
+// max-value tour of it (ties go to the shorter tour). The tour is kept and
+// followed on later calls while the board agrees with it, so only the first
+// call of an ending does any search.
+int endgame_move(CenteEndgame *eg, const Board *b, int self_id,
+                 CenteMove *out);
+
+// Drops the tour being followed (before reusing eg for another game)
+void endgame_reset(CenteEndgame *eg);
+
+#endif
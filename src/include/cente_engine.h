@@ -0,0 +1,66 @@
+#ifndef CENTE_ENGINE_H
+#define CENTE_ENGINE_H
+
+#include "cente_board.h"
+#include "cente_book.h"
+#include "cente_brs.h"
+#include "cente_endgame.h"
+#include "cente_influence.h"
+#include "cente_mcts.h"
+#include "cente_params.h"
+#include "cente_ponder.h"
+#include "cente_stats.h"
+#include "cente_time.h"
+#include "cente_config.h"
+
+// Long-lived per-process state: everything a turn needs is allocated once at
+// startup and the private board is kept in sync from the shared state.
+typedef struct {
+    int width;
+    int height;
+    int self_id;
+    Board *board;      // private copy of the shared board
+    InfluenceMap *inf_base; // base sigma, read by phase detection/autotune
+    InfluenceMap *inf;      // tuned sigma, read by the search
+    float tuned_sigma;      // sigma inf was last built with, 0 if unused
+    MCTSTree *tree;    // search arena, reused across turns
+    CenteBrs *brs;     // best-reply search for close fights
+    int search_mode;   // CENTE_SEARCH_*, from $CENTE_SEARCH
+    CenteBook *book;   // opening book for this size, NULL if none
+    CenteEndgame *endgame; // region tours once we are walled off
+    CentePonder ponder;
+    int has_ponder;
+    CenteTurnClock clock; // turn cadence and adaptive budget
+    CenteParams params;   // built-in, or loaded from $CENTE_PARAMS
+    int synced;        // 0 until the first full copy
+    unsigned int valid_seen[CENTE_MAX_PLAYERS]; // validMove at last sync
+    CenteTurnStats stats; // breakdown of the last engine_choose
+} CenteEngine;
+
+CenteEngine *engine_create(int width, int height, int num_players,
+                           int self_id);
+void engine_destroy(CenteEngine *e);
+// Forgets the previous game: the next sync is a full copy, and the search
+// tree, endgame tour and turn clock start empty
+void engine_reset(CenteEngine *e);
+
+// Picks self_id's move on the synced board: the opening book, then the
+// endgame tour, then a search within `budget`: MCTS (minus pondered_ms when
+// the pondered subtree is reused), or best-reply search when the mode asks
+// for it (in auto mode, while a rival head is close). Starts pondering on
+// the reply after an MCTS turn when enabled. Returns the head position if
+// there is no legal move. Leaves the turn's timings and search counters in
+// e->stats.
+CenteMove engine_choose(CenteEngine *e, CenteBudget budget, int pondered_ms);
+
+// Brings the private board up to date. Players whose validMove advanced by
+// one onto a neighbouring cell are replayed in O(1); anything else (first
+// sync, skipped moves) falls back to copying `cells`. Must be called while
+// holding the read lock. Returns the number of heads that moved.
+int engine_sync(CenteEngine *e, int num_players, const unsigned short *hx,
+                const unsigned short *hy, const unsigned char *blocked,
+                const unsigned int *score, const unsigned int *valid_moves,
+                const int *cells);
+
+#endif
+
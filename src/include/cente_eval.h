@@ -4,10 +4,14 @@
 #include "cente_board.h"
 #include "cente_influence.h"
 #include "cente_config.h"
+#include "cente_params.h"
 
 typedef enum { PHASE_OPENING = 0, PHASE_MIDGAME = 1, PHASE_ENDGAME = 2 } cente_phase;
 
-void phase_detect(const Board *b, const InfluenceMap *inf, cente_phase *phase_out, cente_weights *w_out);
+// Weights for the detected phase are taken from params->phase
+void phase_detect(const Board *b, const InfluenceMap *inf,
+                  const CenteParams *params, cente_phase *phase_out,
+                  cente_weights *w_out);
 
 float centrality_score(const Board *b, CenteMove m);
 float mobility_score(const Board *b, int player_id);
@@ -16,6 +20,24 @@ float risk_proxy(const Board *b, const InfluenceMap *inf, CenteMove m);
 float tempo_score_1ply(const Board *b, int player_id, const InfluenceMap *inf, CenteMove m);
 
 float prior_cente(const Board *b, int player_id, const InfluenceMap *inf, CenteMove m);
+
+// Builds the per-cell centrality table for a width x height board. Call it
+// before starting search threads; calling it again with the same size is a
+// no-op. Without it the functions below compute centrality on the fly.
+void eval_init(int width, int height);
+
+// prior_cente for n moves at once (n <= CENTE_EVAL_BATCH): features are
+// gathered into per-feature arrays, then combined in branch-free loops the
+// compiler vectorises across candidates. Same values as prior_cente.
+#define CENTE_EVAL_BATCH 64
+void prior_cente_batch(const Board *b, int player_id, const InfluenceMap *inf,
+                       const CenteMove *moves, int n, float *out);
+
+// Orders moves best first by a cheap proxy of prior_cente (centrality,
+// territory and cell value), so progressive widening can admit the likely
+// best moves before paying for their priors
+void prior_cente_order(const Board *b, const InfluenceMap *inf,
+                       CenteMove *moves, int n);
 float value_eval(const Board *b, int player_id, const InfluenceMap *inf, const cente_weights *w);
 
 #endif
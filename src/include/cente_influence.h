@@ -2,20 +2,117 @@
 #define CENTE_INFLUENCE_H
 
 #include "cente_board.h"
+#include "cente_convolve.h"
+#include <stdint.h>
 
+// Full rebuild after this many incremental updates to flush float drift
+#ifndef CENTE_INFLUENCE_REFRESH
+#define CENTE_INFLUENCE_REFRESH 64
+#endif
+
+// Side of the square blocks used to track per-map min/max lazily
+#define CENTE_INF_BLOCK 8
+
+// Kernels kept per map, keyed by sigma quantised to 1/CENTE_SIGMA_QUANTUM
+#ifndef CENTE_KERNEL_CACHE
+#define CENTE_KERNEL_CACHE 4
+#endif
+#define CENTE_SIGMA_QUANTUM 16.0f
+
+typedef struct {
+    float sigma;   // quantised; 0 marks an empty slot
+    int radius;
+    float *taps;   // 2*radius+1, normalised
+    CenteIIR iir;
+    int has_iir;   // iir is set up lazily
+    unsigned last_use;
+} CenteKernel;
+
+enum { INF_YOU = 0, INF_RIVAL = 1, INF_T = 2, INF_GRAD = 3, INF_MAPS = 4 };
+
+// Maps hold raw (unnormalised) values; read them through the accessors below,
+// which apply the [0,1] normalisation lazily.
 typedef struct {
     float *iyou;   // size w*h
     float *irival; // size w*h
     float *t;      // territory potential = max(iyou - irival, 0)
     float *grad;   // gradient magnitude of T
+    // Compact maps (see CENTE_INF_COMPACT_CELLS) store the same four planes
+    // as Q16 instead: raw = q * qstep. The float planes are then NULL and
+    // lo/scale are in Q16 units.
+    uint16_t *qyou;
+    uint16_t *qrival;
+    uint16_t *qt;
+    uint16_t *qgrad;
+    float qstep[INF_MAPS]; // set at each full rebuild from the map maxima
+    int qclip;             // a value saturated since then
+    float lo[INF_MAPS];    // per-map minimum
+    float scale[INF_MAPS]; // 1 / (max - min)
     int width;
     int height;
+
+    // Incremental state: the kernel and head seeds the raw maps were built from
+    int valid;
+    int self_id;
+    int num_players;
+    float sigma;   // quantised sigma of the current kernel
+    const float *kernel; // 2*radius+1 taps, owned by kcache
+    int radius;
+    CenteKernel kcache[CENTE_KERNEL_CACHE];
+    unsigned kclock;
+    CenteKernel *cur;
+    unsigned short seed_x[CENTE_MAX_PLAYERS];
+    unsigned short seed_y[CENTE_MAX_PLAYERS];
+    int updates;   // incremental updates since the last full rebuild
+    int blocks_x;
+    int blocks_y;
+    float *blk_lo; // INF_MAPS * blocks_x * blocks_y
+    float *blk_hi;
+
+    int blur;      // CENTE_BLUR_FIR / _IIR / _AUTO
+
+    // 64-byte aligned scratch reused across calls: two seed planes (kept
+    // all-zero between calls), then convolution or recursive-filter work
+    float *work;
+    size_t work_cap; // floats
 } InfluenceMap;
 
+static inline float influence_norm(const InfluenceMap *m, int map, float raw) {
+    return (raw - m->lo[map]) * m->scale[map];
+}
+static inline float influence_you(const InfluenceMap *m, int i) {
+    return influence_norm(m, INF_YOU, m->qyou ? (float)m->qyou[i] : m->iyou[i]);
+}
+static inline float influence_rival(const InfluenceMap *m, int i) {
+    return influence_norm(m, INF_RIVAL,
+                          m->qrival ? (float)m->qrival[i] : m->irival[i]);
+}
+static inline float influence_t(const InfluenceMap *m, int i) {
+    return influence_norm(m, INF_T, m->qt ? (float)m->qt[i] : m->t[i]);
+}
+static inline float influence_grad(const InfluenceMap *m, int i) {
+    return influence_norm(m, INF_GRAD, m->qgrad ? (float)m->qgrad[i] : m->grad[i]);
+}
+
 InfluenceMap *influence_create(int width, int height);
+// Same, choosing the storage explicitly: compact != 0 for Q16 planes
+InfluenceMap *influence_create_storage(int width, int height, int compact);
 void influence_destroy(InfluenceMap *map);
+// Overrides the blur mode picked at creation; the next update rebuilds
+void influence_set_blur(InfluenceMap *map, int mode);
 void compute_influence_full(const Board *b, int self_id, float sigma, InfluenceMap *out);
 
-#endif
+// Same result as compute_influence_full, but when only a few heads moved since
+// the previous call with the same sigma and self_id it subtracts/adds their
+// kernel stamps and refreshes just the (2r+1)^2 windows around them.
+// With the recursive blur every call is a full rebuild.
+void compute_influence_update(const Board *b, int self_id, float sigma, InfluenceMap *out);
+
+// compute_influence_update for several (map, sigma) pairs at once, e.g. the
+// base and tuned maps of a turn. Maps that need a full rebuild share one
+// seeding pass over the heads. Maps must all have the board's size.
+void compute_influence_multi(const Board *b, int self_id, const float *sigmas,
+                             InfluenceMap **outs, int count);
 
+#endif
 
@@ -0,0 +1,59 @@
+#ifndef CENTE_KERNELS_H
+#define CENTE_KERNELS_H
+
+#include "cente_board.h"
+#include "cente_influence.h"
+
+// Board sizes with kernels compiled for a fixed width and height, so
+// neighbour offsets and row strides are constants the compiler can fold,
+// unroll and vectorise. Other sizes use the generic variants. Legal moves, the
+// territory refresh and the influence convolution are not dispatched: their
+// fixed-size variants were no faster than the generic code in cente_bench.
+// The third argument names the count_stats variant of each size: it only
+// paid off up to 15x15, so the larger boards keep the generic one.
+#define CENTE_KERNEL_SIZES(X)                                                  \
+    X(10, 10, 10x10) X(15, 15, 15x15) X(19, 19, generic) X(20, 20, generic)
+// Sizes with a board_count_stats variant (the third arguments above)
+#define CENTE_COUNT_STATS_SIZES(X) X(10, 10) X(15, 15)
+
+#if defined(__GNUC__)
+#define CENTE_FORCE_INLINE static inline __attribute__((always_inline))
+#else
+#define CENTE_FORCE_INLINE static inline
+#endif
+
+typedef struct {
+    int width, height;  // 0 for the generic table
+    const char *name;
+    // cente_board.c
+    void (*count_stats)(Board *b); // occupied, free_value, free_nbr
+    // cente_eval.c
+    void (*prior_batch)(const Board *b, int player_id, const InfluenceMap *inf,
+                        const CenteMove *moves, int n, float *out);
+} CenteKernels;
+
+// Picks the table for width x height; call once at startup, before any
+// thread uses the engine. Calling it again with the same size is a no-op.
+void kernels_init(int width, int height);
+
+// The table picked by kernels_init when the size matches, else the generic
+const CenteKernels *kernels_for(int width, int height);
+const CenteKernels *kernels_generic(void);
+// Specialised table for width x height, NULL if there is none
+const CenteKernels *kernels_lookup(int width, int height);
+
+// Variants, defined next to the code they specialise: board_count_stats_10x10
+// and so on, plus the *_generic ones that read the size from the arguments
+#define CENTE_COUNT_STATS_DECLARE(S) void board_count_stats_##S(Board *b);
+#define CENTE_PRIOR_BATCH_DECLARE(S)                                           \
+    void prior_cente_batch_##S(const Board *b, int player_id,                  \
+                               const InfluenceMap *inf,                        \
+                               const CenteMove *moves, int n, float *out);
+#define CENTE_COUNT_STATS_DECLARE_WH(W, H) CENTE_COUNT_STATS_DECLARE(W##x##H)
+#define CENTE_PRIOR_BATCH_DECLARE_WH(W, H, S) CENTE_PRIOR_BATCH_DECLARE(W##x##H)
+CENTE_COUNT_STATS_SIZES(CENTE_COUNT_STATS_DECLARE_WH)
+CENTE_KERNEL_SIZES(CENTE_PRIOR_BATCH_DECLARE_WH)
+CENTE_COUNT_STATS_DECLARE(generic)
+CENTE_PRIOR_BATCH_DECLARE(generic)
+
+#endif
@@ -6,26 +6,68 @@
 #include "cente_influence.h"
 #include "cente_eval.h"
 #include "cente_config.h"
+#include "cente_time.h"
 
+// A node is a position where self_id is about to move. Edges are our action
+// followed by the predicted (greedy) replies of every opponent, so the
+// position behind each edge is deterministic and can be matched by hash.
 typedef struct {
     uint64_t hash;
     int visits;
     float value_sum;
-    int num_children;
+    int num_children;  // admitted so far (progressive widening)
+    int num_legal;     // candidates in actions[], best first by a cheap proxy
+    float prior_mass;  // sum of exp(raw prior) over the admitted children
+    int expanded;
     CenteMove actions[CENTE_MAX_CHILDREN];
     float priors[CENTE_MAX_CHILDREN];
     int child_visits[CENTE_MAX_CHILDREN];
     float child_q[CENTE_MAX_CHILDREN];
+    int children[CENTE_MAX_CHILDREN]; // node index, -1 if not allocated
 } MCTSNode;
 
+typedef struct MCTSTree MCTSTree;
+
 void mcts_reset(void);
 void mcts_set_params(const cente_mcts_params *params);
 void mcts_set_size_params(const cente_size_params *size_params);
 
+MCTSTree *mcts_tree_create(int width, int height, int capacity);
+void mcts_tree_destroy(MCTSTree *t);
+
+// Drops every node, e.g. between unrelated games
+void mcts_tree_clear(MCTSTree *t);
+
+// Points the tree root at `root`. Keeps the current root (and its statistics)
+// when its hash matches, otherwise clears the tree. Returns 1 on reuse.
+int mcts_tree_set_root(MCTSTree *t, const Board *root, int self_id);
+
+// Re-roots the tree at the position expected after we play `played` from
+// `root` and every opponent answers with its predicted reply. `predicted`
+// must have its own cells buffer of the same size; it receives that position.
+// Returns 1 if an existing subtree was kept.
+int mcts_tree_advance(MCTSTree *t, const Board *root, int self_id,
+                      CenteMove played, Board *predicted);
+
+// Searches from the tree root (set with mcts_tree_set_root) until the
+// budget's stopping rule fires (see search_clock_done) or *stop becomes
+// non-zero. stop may be NULL.
+CenteMove mcts_search(MCTSTree *t, const Board *root, int self_id,
+                      const InfluenceMap *inf, const cente_weights *w,
+                      const cente_mcts_params *params,
+                      const CenteBudget *budget, const volatile int *stop);
+
+// Copies the root's actions and their visit counts (at most max); returns
+// how many were written
+int mcts_root_visits(const MCTSTree *t, CenteMove *moves, int *visits,
+                     int max);
+
+// Iterations run and deepest descent (our moves) of the last mcts_search
+void mcts_last_stats(const MCTSTree *t, int *iterations, int *max_depth);
+
 CenteMove mcts_select(const Board *root, int self_id, const InfluenceMap *inf,
                       const cente_weights *w, const cente_mcts_params *params,
                       int budget_ms);
 
 #endif
 
-
@@ -0,0 +1,35 @@
+#ifndef CENTE_PARAMS_H
+#define CENTE_PARAMS_H
+
+#include "cente_config.h"
+
+// Every tunable constant of the engine in one place, so a tuner can vary
+// them per seat and a parameter file can override the built-in values
+typedef struct {
+    cente_weights phase[3];     // indexed by cente_phase
+    cente_mcts_params tier[3];  // indexed by cente_size_tier
+} CenteParams;
+
+void cente_params_defaults(CenteParams *p);
+
+// Size tier parameters with the search parameters taken from p
+cente_size_params cente_params_for_size(const CenteParams *p, int width,
+                                        int height);
+
+// Text files of "name value" lines ('#' starts a comment). Names not in the
+// file keep their current value; an unknown name or a bad value fails the
+// load with p partly updated. Both return 0 on success.
+int cente_params_load(const char *path, CenteParams *p);
+int cente_params_save(const char *path, const CenteParams *p);
+
+// Scalar view for optimisers: parameter i has a name, a range and the tier
+// it belongs to (-1 for the phase weights). Integer parameters are rounded
+// on cente_params_put, and every value is clamped to its range.
+int cente_params_count(void);
+const char *cente_params_name(int i);
+void cente_params_range(int i, double *lo, double *hi);
+int cente_params_tier(int i);
+double cente_params_get(const CenteParams *p, int i);
+void cente_params_put(CenteParams *p, int i, double v);
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef CENTE_PONDER_H
+#define CENTE_PONDER_H
+
+#include <pthread.h>
+#include "cente_board.h"
+#include "cente_influence.h"
+#include "cente_eval.h"
+#include "cente_mcts.h"
+#include "cente_config.h"
+
+// Background search on the position we expect after our move and the
+// predicted opponent replies. The tree is handed back to the caller on stop.
+typedef struct {
+    pthread_t thread;
+    int running;
+    volatile int stop;
+    int self_id;
+    float sigma;
+    cente_weights weights;
+    cente_mcts_params params;
+    unsigned long long started_ms;
+    int paused;    // ponder_stop interrupted a search ponder_resume may continue
+    int banked_ms; // time pondered on this tree before the last resume
+    MCTSTree *tree;
+    Board predicted; // owns its cells buffer
+    InfluenceMap *inf;
+} CentePonder;
+
+int ponder_init(CentePonder *pd, int width, int height);
+void ponder_destroy(CentePonder *pd);
+
+// Re-roots `tree` at the predicted reply to `played` and keeps searching it in
+// a background thread. The tree must not be touched until ponder_stop.
+void ponder_start(CentePonder *pd, MCTSTree *tree, const Board *root,
+                  int self_id, CenteMove played, float sigma,
+                  const cente_weights *w, const cente_mcts_params *params);
+
+// Stops the background search and returns how long it ran since
+// ponder_start, in ms, resumed spans included (0 if it was not running).
+int ponder_stop(CentePonder *pd);
+
+// Continues the search the last ponder_stop interrupted, on the same tree and
+// predicted position; for a wake-up that is not our turn, when nothing has
+// touched the tree since. No-op when that stop found nothing running.
+void ponder_resume(CentePonder *pd);
+
+// Forgets a paused search (the tree was cleared)
+void ponder_cancel(CentePonder *pd);
+
+#endif
+
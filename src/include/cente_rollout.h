@@ -0,0 +1,51 @@
+#ifndef CENTE_ROLLOUT_H
+#define CENTE_ROLLOUT_H
+
+#include <stdint.h>
+#include "cente_board.h"
+#include "cente_influence.h"
+#include "cente_eval.h"
+#include "cente_config.h"
+
+// xorshift64* generator: cheap, allocation free and good enough for playouts.
+typedef struct {
+    uint64_t s;
+} CenteRng;
+
+static inline void cente_rng_seed(CenteRng *r, uint64_t seed) {
+    r->s = seed ? seed : 0x9e3779b97f4a7c15ULL;
+}
+
+static inline uint64_t cente_rng_next(CenteRng *r) {
+    uint64_t x = r->s;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    r->s = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+// Uniform float in [0,1)
+static inline float cente_rng_float(CenteRng *r) {
+    return (float)(cente_rng_next(r) >> 40) * (1.0f / 16777216.0f);
+}
+
+// Builds the neighbour tables for a width x height board. Must be called
+// before rollout_run (and before any search thread is started); calling it
+// again with the same size is a no-op.
+void rollout_init(int width, int height);
+
+// Applies the deterministic (epsilon = 0) policy move of every live opponent
+// of self_id, in turn order. Used by the search tree to predict replies.
+void rollout_predict_replies(Board *b, int self_id);
+
+// Advances every live player for `depth` plies with an epsilon-greedy policy,
+// mutating `scratch` in place, then evaluates it for self_id.
+// Opponents move first in each ply since self_id has just moved.
+// Returns a value in [0,1]; dying early in the playout scores close to 0.
+float rollout_run(Board *scratch, int self_id, const InfluenceMap *inf,
+                  const cente_weights *w, int depth, float epsilon,
+                  CenteRng *rng);
+
+#endif
+
@@ -0,0 +1,46 @@
+#ifndef CENTE_STATS_H
+#define CENTE_STATS_H
+
+#include <stdio.h>
+#include "cente_board.h"
+#include "cente_config.h"
+
+// How a turn's move was found
+#define CENTE_TURN_BOOK 0
+#define CENTE_TURN_ENDGAME 1
+#define CENTE_TURN_MCTS 2
+#define CENTE_TURN_BRS 3
+
+// One turn of player_cente, filled by engine_choose (the sync time and turn
+// number by the player loop). Times are in milliseconds.
+typedef struct {
+    int turn;
+    int self_id;
+    int mode;              // CENTE_TURN_*
+    double sync_ms;        // engine_sync: board copy or replay
+    double influence_ms;   // influence maps for this turn
+    int influence_builds;  // maps rebuilt or updated (0..2)
+    double phase_ms;       // phase_detect
+    double autotune_ms;    // cente_autotune
+    double search_ms;      // mcts_search or brs_search
+    double total_ms;       // engine_choose as a whole
+    int soft_ms, hard_ms;  // budget handed to the search
+    int pondered_ms;       // search time reused from pondering
+    long iterations;       // MCTS iterations or BRS nodes
+    int max_depth;         // deepest descent (MCTS) or completed depth (BRS)
+    int root_n;            // root children below
+    CenteMove root_moves[CENTE_MAX_CHILDREN];
+    int root_visits[CENTE_MAX_CHILDREN];
+} CenteTurnStats;
+
+// Where $CENTE_STATS sends the per-turn lines: unset, empty or "0" disables
+// them (NULL), "1" or "stderr" selects stderr, anything else is a file path
+// opened for appending
+FILE *cente_stats_open(void);
+void cente_stats_close(FILE *f);
+
+// Appends one JSON object per line, with nodes/sec derived from the search
+// time
+void cente_stats_write(FILE *f, const CenteTurnStats *s);
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef CENTE_TIME_H
+#define CENTE_TIME_H
+
+#include "cente_config.h"
+
+// Thinking time for one search
+typedef struct {
+    int soft_ms;    // normal budget
+    int hard_ms;    // never exceeded; close races are extended up to it
+    int early_stop; // stop as soon as the best root move cannot be caught
+} CenteBudget;
+
+static inline CenteBudget cente_budget_fixed(int ms) {
+    CenteBudget b = {ms, ms, 0};
+    return b;
+}
+
+// Monotonic milliseconds
+unsigned long long cente_now_ms(void);
+// Monotonic microseconds, for per-turn timings
+unsigned long long cente_now_us(void);
+// CPUs this process may run on (its affinity mask, e.g. after master -a)
+int cente_usable_cpus(void);
+
+// Anytime stopping rule for the search loop. The clock is read only every
+// `check_every` iterations, a stride re-derived from the measured rate.
+typedef struct {
+    unsigned long long start_ms;
+    unsigned long long deadline_ms;
+    unsigned long long hard_ms;
+    int early_stop;
+    int extended;
+    int iters;
+    int next_check;
+    int check_every;
+} CenteSearchClock;
+
+void search_clock_start(CenteSearchClock *c, const CenteBudget *b);
+
+// Call once per iteration with the root's per-child visit counts. Returns 1
+// when the search should stop: deadline reached, or the visit lead of the
+// best child exceeds the iterations that fit in the time left.
+int search_clock_done(CenteSearchClock *c, const int *child_visits, int n);
+
+// Per-game turn clock: measures the master's cadence between turns and
+// adapts the budget to whether our moves land before the next turn.
+typedef struct {
+    unsigned long long last_wake_ms;
+    float cadence_ms; // EWMA of the interval between turns, 0 until measured
+    float budget_ms;  // adapted soft budget, 0 until the first turn
+} CenteTurnClock;
+
+void turn_clock_init(CenteTurnClock *tc);
+
+// Call when wait_for_turn returns
+void turn_clock_wake(CenteTurnClock *tc);
+
+// Call once the outcome of our last written move is known: landed = 1 if
+// the master had applied it by the following turn
+void turn_clock_feedback(CenteTurnClock *tc, int landed);
+
+// Budget for this turn; tier_ms (the size tier default) seeds it
+CenteBudget turn_clock_budget(CenteTurnClock *tc, int tier_ms);
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef CENTE_VORONOI_H
+#define CENTE_VORONOI_H
+
+#include "cente_board.h"
+#include "cente_config.h"
+
+// Cells each player reaches strictly before every other live head, walking
+// 8-connected through free cells. Cells reached by two heads on the same
+// step belong to nobody.
+typedef struct {
+    int count[CENTE_MAX_PLAYERS];
+    long long value[CENTE_MAX_PLAYERS]; // sum of the cell values
+} VoronoiResult;
+
+typedef struct VoronoiScratch VoronoiScratch;
+
+VoronoiScratch *voronoi_create(int width, int height);
+void voronoi_destroy(VoronoiScratch *s);
+
+// Simultaneous BFS from all non-blocked heads, one bitboard dilation per
+// player per step. Uses (and clobbers) b->bits' dilation rows.
+void voronoi_eval(Board *b, VoronoiScratch *s, VoronoiResult *out);
+
+#endif
@@ -7,6 +7,28 @@
 void zobrist_init(int width, int height, int num_players);
 uint64_t zobrist_hash_board(const Board *b);
 
-#endif
+// Board symmetries: bit 0 mirrors x, bit 1 mirrors y, bit 2 transposes
+// first (square boards only, so rectangles have 4 and squares 8)
+static inline int zobrist_sym_count(int width, int height) {
+    return width == height ? 8 : 4;
+}
+
+static inline void zobrist_sym_point(int sym, int width, int height, int x,
+                                     int y, int *ox, int *oy) {
+    if (sym & 4) {
+        int t = x;
+        x = y;
+        y = t;
+    }
+    if (sym & 1)
+        x = width - 1 - x;
+    if (sym & 2)
+        y = height - 1 - y;
+    *ox = x;
+    *oy = y;
+}
 
+// zobrist_hash_board of the board mapped through `sym`, without building it
+uint64_t zobrist_hash_sym(const Board *b, int sym);
 
+#endif
@@ -11,6 +11,11 @@ extern int delay;
 extern int timeout;
 extern int seed;
 extern char *view_path;
+extern int group_players;
+extern int pin_processes;
+extern int player_nice;
+extern int master_fifo;
+extern int use_io_uring;
 
 // Funciones de configuración
 void print_usage(const char *program_name);
@@ -0,0 +1,43 @@
+#ifndef GAME_LOCK_H
+#define GAME_LOCK_H
+
+#include <pthread.h>
+#include <sys/types.h>
+
+#define SHM_GAME_LOCK "/game_lock"
+#define GAME_LOCK_READERS 32
+
+// Crash-robust readers-writer lock for the game state, in its own segment so
+// semaphore_struct keeps its layout. The mutex is robust and process-shared:
+// if a process dies holding it the next locker gets EOWNERDEAD and rebuilds
+// `readers` from the slots. Every reader inside records its pid in a slot, so
+// the writer can drop readers that died without releasing.
+typedef struct {
+    pthread_mutex_t mutex;  // guards the fields below; held while writing
+    pthread_cond_t changed; // a reader left or the writer finished
+    int writer;             // writer inside or waiting: readers hold back
+    int readers;            // readers inside
+    pid_t reader_pid[GAME_LOCK_READERS]; // 0 = free slot
+} game_lock;
+
+// Master: creates and initialises the segment / unmaps and unlinks it
+game_lock *create_game_lock(void);
+void destroy_game_lock(game_lock *l);
+
+// Readers: maps the master's segment; NULL if there is none
+game_lock *open_game_lock(void);
+void close_game_lock(game_lock *l);
+
+int game_lock_read_acquire(game_lock *l);
+int game_lock_read_release(game_lock *l);
+
+// Waits for the readers inside, dropping the ones whose process is gone, and
+// returns holding the mutex until game_lock_write_release
+int game_lock_write_acquire(game_lock *l);
+void game_lock_write_release(game_lock *l);
+
+// Frees the slots of a process known to be dead (e.g. from its pidfd);
+// returns how many it held
+int game_lock_reap(game_lock *l, pid_t pid);
+
+#endif
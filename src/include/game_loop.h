@@ -5,6 +5,9 @@
 #include "game_semaphore.h"
 
 // Función principal del loop del juego
-void run_game_loop(int num_players, pid_t view_pid);
+void run_game_loop(int num_players, pid_t player_pids[], pid_t view_pid);
+
+// Resumen del retraso de los ticks medido por run_game_loop
+void print_tick_jitter(void);
 
 #endif // GAME_LOOP_H
@@ -4,12 +4,21 @@
 #include <sys/types.h>
 #include "game.h"
 
+// Descriptor por el que escribe el asiento k (k >= 1) de un proceso que
+// atiende a varios jugadores; el asiento 0 usa stdout
+#define PLAYER_SEAT_FD(k) (2 + (k))
+
 // Variables globales de comunicación
 extern int player_pipes[9][2];
 
+// Ubicación de procesos según -a/-f: fija el máster y prepara el reparto de
+// CPUs para los hijos. Llamar antes de crear la vista y los jugadores.
+void placement_init(void);
+
 // Funciones de comunicación IPC
 int create_player_pipes();
 pid_t create_view_process(int width, int height);
-pid_t create_player_process(const char *player_executable, int pipe_fd);
+pid_t create_player_process(const char *player_executable, int first_seat,
+                            int seats);
 
 #endif // IPC_COMMUNICATION_H
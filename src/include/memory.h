@@ -3,15 +3,23 @@
 
 #include "game.h"
 #include "game_semaphore.h"
+#include "game_lock.h"
 
 // Variables globales de memoria
 extern int game_shm_fd, sem_shm_fd;
 extern game *game_state;
 extern semaphore_struct *game_semaphores;
+extern game_lock *game_state_lock;
 
 // Funciones de gestión de memoria
 int create_game_shared_memory(int width, int height, int num_players);
 int create_semaphore_shared_memory();
 void cleanup_memory(int width, int height);
 
+// Escritura exclusiva del estado: toma el lock robusto y, con espera acotada,
+// los semáforos C y D que usan los lectores del protocolo anterior. Devuelve
+// cuáles de estos quedaron tomados, para pasárselo a unlock_state_write.
+int lock_state_write(void);
+void unlock_state_write(int held);
+
 #endif // MEMORY_H
@@ -0,0 +1,30 @@
+#ifndef PLAYER_IO_H
+#define PLAYER_IO_H
+
+#include <sys/types.h>
+
+// Eventos de un jugador informados por player_io_wait
+#define PLAYER_IO_READABLE 1 // hay al menos un byte para player_io_read
+#define PLAYER_IO_HANGUP 2   // pipe cerrado o con error
+#define PLAYER_IO_DIED 4     // el proceso terminó (pidfd)
+
+// Lectura de los pipes de los jugadores. Por defecto poll + un read por
+// movimiento; con -u, io_uring con lecturas multishot sobre un anillo de
+// buffers registrado, y poll si el kernel no lo soporta. pidfds[i] puede ser
+// -1; después de informar PLAYER_IO_DIED no se vuelve a usar.
+void player_io_open(int num_players, const int pidfds[]);
+void player_io_close(void);
+
+// Espera hasta timeout_ms a que algún jugador tenga eventos. Devuelve cuántos
+// los tienen (0 si venció el plazo, -1 si hubo error)
+int player_io_wait(int events[], int timeout_ms);
+
+// Un byte del jugador: 1 si lo hubo, 0 en EOF y -1 con errno (EAGAIN si
+// todavía no hay datos)
+ssize_t player_io_read(int player, unsigned char *byte);
+
+// Llamadas al sistema de lectura (poll, read, io_uring_enter) por movimiento
+// leído; el resto de las llamadas del tick no se cuentan
+void print_player_io_stats(void);
+
+#endif // PLAYER_IO_H
@@ -0,0 +1,224 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+// Crash-robust readers-writer lock over shared memory (see game_lock.h)
+#ifdef __linux__
+#define _GNU_SOURCE // robust mutexes, waitid(WNOWAIT)
+#endif
+#include "../include/game_lock.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// How often a waiting writer re-checks that the readers inside are alive
+#define GAME_LOCK_POLL_NS 10000000L
+
+game_lock *create_game_lock(void) {
+  int fd = shm_open(SHM_GAME_LOCK, O_CREAT | O_RDWR, 0666);
+  if (fd == -1) {
+    perror("shm_open game_lock");
+    return NULL;
+  }
+  if (ftruncate(fd, (off_t)sizeof(game_lock)) == -1) {
+    perror("ftruncate game_lock");
+    close(fd);
+    return NULL;
+  }
+  game_lock *l = mmap(NULL, sizeof(game_lock), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+  close(fd);
+  if (l == MAP_FAILED) {
+    perror("mmap game_lock");
+    return NULL;
+  }
+  memset(l, 0, sizeof(*l));
+
+  pthread_mutexattr_t ma;
+  pthread_mutexattr_init(&ma);
+  pthread_mutexattr_setpshared(&ma, PTHREAD_PROCESS_SHARED);
+#ifdef __linux__
+  pthread_mutexattr_setrobust(&ma, PTHREAD_MUTEX_ROBUST);
+#endif
+  int rc = pthread_mutex_init(&l->mutex, &ma);
+  pthread_mutexattr_destroy(&ma);
+
+  pthread_condattr_t ca;
+  pthread_condattr_init(&ca);
+  pthread_condattr_setpshared(&ca, PTHREAD_PROCESS_SHARED);
+  pthread_condattr_setclock(&ca, CLOCK_MONOTONIC);
+  if (rc == 0)
+    rc = pthread_cond_init(&l->changed, &ca);
+  pthread_condattr_destroy(&ca);
+  if (rc != 0) {
+    fprintf(stderr, "create_game_lock: %s\n", strerror(rc));
+    munmap(l, sizeof(game_lock));
+    return NULL;
+  }
+  return l;
+}
+
+void destroy_game_lock(game_lock *l) {
+  if (l) {
+    pthread_cond_destroy(&l->changed);
+    pthread_mutex_destroy(&l->mutex);
+    munmap(l, sizeof(game_lock));
+  }
+  shm_unlink(SHM_GAME_LOCK);
+}
+
+game_lock *open_game_lock(void) {
+  int fd = shm_open(SHM_GAME_LOCK, O_RDWR, 0666);
+  if (fd == -1)
+    return NULL;
+  struct stat sb;
+  if (fstat(fd, &sb) == -1 || (size_t)sb.st_size < sizeof(game_lock)) {
+    close(fd);
+    return NULL;
+  }
+  game_lock *l = mmap(NULL, sizeof(game_lock), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+  close(fd);
+  return l == MAP_FAILED ? NULL : l;
+}
+
+void close_game_lock(game_lock *l) {
+  if (l)
+    munmap(l, sizeof(game_lock));
+}
+
+// Zombies count as dead: the master's children stay zombies until
+// wait_for_processes, and kill(pid, 0) still succeeds on them
+static int pid_alive(pid_t pid) {
+#ifdef __linux__
+  siginfo_t si;
+  si.si_pid = 0;
+  if (waitid(P_PID, (id_t)pid, &si, WEXITED | WNOHANG | WNOWAIT) == 0)
+    return si.si_pid == 0;
+#endif
+  return kill(pid, 0) == 0 || errno == EPERM;
+}
+
+static void recount(game_lock *l) {
+  l->readers = 0;
+  for (int i = 0; i < GAME_LOCK_READERS; i++)
+    l->readers += l->reader_pid[i] != 0;
+}
+
+// The previous owner died inside one of the short bookkeeping sections, so
+// the slots are right but `readers` may be one off
+static int lock_checked(game_lock *l, int rc) {
+#ifdef __linux__
+  if (rc == EOWNERDEAD) {
+    recount(l);
+    pthread_mutex_consistent(&l->mutex);
+    rc = 0;
+  }
+#endif
+  return rc;
+}
+
+static int lock(game_lock *l) {
+  return lock_checked(l, pthread_mutex_lock(&l->mutex));
+}
+
+static void drop_dead_readers(game_lock *l) {
+  for (int i = 0; i < GAME_LOCK_READERS; i++)
+    if (l->reader_pid[i] && !pid_alive(l->reader_pid[i]))
+      l->reader_pid[i] = 0;
+  recount(l);
+}
+
+int game_lock_read_acquire(game_lock *l) {
+  if (lock(l) != 0)
+    return -1;
+  // Like the turnstile: a waiting writer goes first
+  while (l->writer) {
+    if (lock_checked(l, pthread_cond_wait(&l->changed, &l->mutex)) != 0) {
+      pthread_mutex_unlock(&l->mutex);
+      return -1;
+    }
+  }
+  int slot = 0;
+  while (slot < GAME_LOCK_READERS && l->reader_pid[slot])
+    slot++;
+  if (slot == GAME_LOCK_READERS) {
+    pthread_mutex_unlock(&l->mutex);
+    return -1;
+  }
+  l->reader_pid[slot] = getpid();
+  l->readers++;
+  pthread_mutex_unlock(&l->mutex);
+  return 0;
+}
+
+int game_lock_read_release(game_lock *l) {
+  if (lock(l) != 0)
+    return -1;
+  pid_t self = getpid();
+  for (int i = 0; i < GAME_LOCK_READERS; i++) {
+    if (l->reader_pid[i] == self) {
+      l->reader_pid[i] = 0;
+      l->readers--;
+      break;
+    }
+  }
+  if (l->readers == 0)
+    pthread_cond_broadcast(&l->changed);
+  pthread_mutex_unlock(&l->mutex);
+  return 0;
+}
+
+int game_lock_write_acquire(game_lock *l) {
+  if (lock(l) != 0)
+    return -1;
+  l->writer = 1;
+  while (l->readers > 0) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_nsec += GAME_LOCK_POLL_NS;
+    if (ts.tv_nsec >= 1000000000L) {
+      ts.tv_sec++;
+      ts.tv_nsec -= 1000000000L;
+    }
+    int rc = lock_checked(
+        l, pthread_cond_timedwait(&l->changed, &l->mutex, &ts));
+    if (rc == ETIMEDOUT) {
+      drop_dead_readers(l);
+    } else if (rc != 0) {
+      l->writer = 0;
+      pthread_mutex_unlock(&l->mutex);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+void game_lock_write_release(game_lock *l) {
+  l->writer = 0;
+  pthread_cond_broadcast(&l->changed);
+  pthread_mutex_unlock(&l->mutex);
+}
+
+int game_lock_reap(game_lock *l, pid_t pid) {
+  if (lock(l) != 0)
+    return 0;
+  int freed = 0;
+  for (int i = 0; i < GAME_LOCK_READERS; i++) {
+    if (l->reader_pid[i] == pid) {
+      l->reader_pid[i] = 0;
+      freed++;
+    }
+  }
+  if (freed) {
+    recount(l);
+    pthread_cond_broadcast(&l->changed);
+  }
+  pthread_mutex_unlock(&l->mutex);
+  return freed;
+}
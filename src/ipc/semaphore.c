@@ -3,6 +3,7 @@
 // Minimal IPC for semaphores over shared memory (unnamed semaphores)
 #include "../include/game.h"
 #include "../include/game_semaphore.h"
+#include "../include/game_lock.h"
 #include <fcntl.h>
 #include <semaphore.h>
 #include <stdio.h>
@@ -12,6 +13,10 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+// Robust state lock from the master, if it created one; without it readers
+// fall back to the semaphore protocol below
+static game_lock *state_lock = NULL;
+
 // Map the shared semaphore segment created by master
 semaphore_struct *open_semaphore_memory() {
   int fd = shm_open(SHM_SEM, O_RDWR, 0666);
@@ -41,12 +46,15 @@ semaphore_struct *open_semaphore_memory() {
     return NULL;
   }
   close(fd);
+  state_lock = open_game_lock();
   return sem_state;
 }
 
 void close_semaphore_memory(semaphore_struct *sem_state) {
   if (!sem_state)
     return;
+  close_game_lock(state_lock);
+  state_lock = NULL;
   if (munmap(sem_state, sizeof(semaphore_struct)) == -1) {
     perror("close_semaphore_memory: munmap");
   }
@@ -65,6 +73,8 @@ int wait_for_turn(semaphore_struct *sem_state, int player_id) {
 int acquire_read_access(semaphore_struct *sem_state) {
   if (!sem_state)
     return -1;
+  if (state_lock)
+    return game_lock_read_acquire(state_lock);
   // cumple un rol estilo molinete
   sem_wait(&sem_state->game_master_mutex);
   sem_post(&sem_state->game_master_mutex);
@@ -87,6 +97,8 @@ int acquire_read_access(semaphore_struct *sem_state) {
 int release_read_access(semaphore_struct *sem_state) {
   if (!sem_state)
     return -1;
+  if (state_lock)
+    return game_lock_read_release(state_lock);
   if (sem_wait(&sem_state->game_reader_mutex) == -1)
     return -1;
   if (sem_state->game_players_count > 0)
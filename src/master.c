@@ -7,6 +7,7 @@
 #include "include/game_init.h"
 #include "include/ipc_communication.h"
 #include "include/game_loop.h"
+#include "include/player_io.h"
 #include "include/game_results.h"
 #include <errno.h>
 #include <fcntl.h>
@@ -27,6 +28,7 @@ int main(int argc, char *argv[]) {
   // Limpiar cualquier segmento de memoria compartida previo
   shm_unlink(SHM_STATE);
   shm_unlink(SHM_SEM);
+  shm_unlink(SHM_GAME_LOCK);
 
   // Variables locales
   int width, height, num_players;
@@ -55,6 +57,9 @@ int main(int argc, char *argv[]) {
   initialize_players(player_executables, num_players);
   initialize_board();
 
+  // Ubicar el máster y preparar el reparto de CPUs de los hijos (-a, -f)
+  placement_init();
+
   // Crear pipes de comunicación
   if (create_player_pipes() == -1) {
     return EXIT_FAILURE;
@@ -68,19 +73,28 @@ int main(int argc, char *argv[]) {
     }
   }
 
-  // Crear procesos de jugadores
-  for (int i = 0; i < num_players; i++) {
-    player_pids[i] = create_player_process(player_executables[i], player_pipes[i][1]);
+  // Crear procesos de jugadores. Con -g, los jugadores consecutivos con el
+  // mismo binario comparten un proceso (un pipe por asiento)
+  for (int i = 0; i < num_players;) {
+    int seats = 1;
+    while (group_players && i + seats < num_players &&
+           strcmp(player_executables[i + seats], player_executables[i]) == 0)
+      seats++;
+    pid_t pid = create_player_process(player_executables[i], i, seats);
 
-    if (player_pids[i] == -1) {
+    if (pid == -1) {
       return EXIT_FAILURE;
     }
-    // Registrar PID del jugador en el estado compartido (protegido por D)
-    sem_wait(&game_semaphores->game_state_mutex);
-    game_state->players[i].pid = player_pids[i];
-    sem_post(&game_semaphores->game_state_mutex);
-    // Cerrar el extremo de escritura del pipe en el padre
-    close(player_pipes[i][1]);
+    for (int k = i; k < i + seats; k++) {
+      player_pids[k] = pid;
+      // Registrar PID del jugador en el estado compartido
+      int held = lock_state_write();
+      game_state->players[k].pid = pid;
+      unlock_state_write(held);
+      // Cerrar el extremo de escritura del pipe en el padre
+      close(player_pipes[k][1]);
+    }
+    i += seats;
   }
 
   printf("Todos los procesos creados. Iniciando juego...\n");
@@ -91,12 +105,14 @@ int main(int argc, char *argv[]) {
   }
 
   // Ejecutar el loop principal del juego
-  run_game_loop(num_players, view_pid);
+  run_game_loop(num_players, player_pids, view_pid);
 
   // Calcular y mostrar resultados
   int winner = calculate_winner(num_players);
   wait_for_processes(num_players, player_pids, view_pid);
   print_final_results(num_players, winner);
+  print_tick_jitter();
+  print_player_io_stats();
 
   // Limpiar recursos
   cleanup_memory(width, height);
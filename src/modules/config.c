@@ -12,11 +12,19 @@ int timeout =
 int seed =
     0; // semilla utilizada para la generación del tablero (0 = time(NULL))
 char *view_path = NULL; // ruta del binario de la vista
+int group_players =
+    0; // 1 = un solo proceso para jugadores consecutivos con el mismo binario
+int pin_processes =
+    0; // 1 = máster en una CPU propia y el resto repartido en las demás
+int player_nice = 0; // nice de la vista y los jugadores (0 = sin cambios)
+int master_fifo = 0; // 1 = SCHED_FIFO para el máster
+int use_io_uring = 0; // 1 = leer a los jugadores con io_uring (Linux)
 
 void print_usage(const char *program_name) {
   fprintf(stderr,
           "Uso: %s [-w width] [-h height] [-d delay] [-t timeout] [-s seed] "
-          "[-v view] -p player_cente [player_cente ...]\n",
+          "[-v view] [-g] [-a] [-n nice] [-f] [-u] -p player_cente "
+          "[player_cente ...]\n",
           program_name);
   fprintf(stderr,
           "  -w width    Ancho del tablero (mínimo 10, por defecto 10)\n");
@@ -31,6 +39,16 @@ void print_usage(const char *program_name) {
   fprintf(
       stderr,
       "  -v view     Ruta del binario de la vista (por defecto sin vista)\n");
+  fprintf(stderr, "  -g          Un solo proceso atiende a jugadores "
+                  "consecutivos con el mismo binario\n");
+  fprintf(stderr, "  -a          Fija el máster a una CPU y reparte vista y "
+                  "jugadores entre las demás (Linux)\n");
+  fprintf(stderr, "  -n nice     Nice de la vista y los jugadores (0..19, "
+                  "por defecto 0)\n");
+  fprintf(stderr, "  -f          SCHED_FIFO para el máster (requiere "
+                  "privilegios, Linux)\n");
+  fprintf(stderr, "  -u          Lee los pipes de los jugadores con io_uring "
+                  "(Linux >= 6.7, si no usa poll)\n");
   fprintf(stderr, "  -p player   Ruta/s de los binarios de los jugadores "
                   "(mínimo 1, máximo 9)\n");
   fprintf(stderr, "              Ejemplo: -p player_cente player_cente\n");
@@ -45,7 +63,7 @@ int parse_arguments(int argc, char *argv[], int *width, int *height,
 
   // Parsear argumentos de línea de comandos con getopt
   int opt;
-  while ((opt = getopt(argc, argv, "w:h:d:t:s:v:p:")) != -1) {
+  while ((opt = getopt(argc, argv, "w:h:d:t:s:v:gan:fup:")) != -1) {
     switch (opt) {
     case 'w':
       *width = atoi(optarg);
@@ -65,6 +83,25 @@ int parse_arguments(int argc, char *argv[], int *width, int *height,
     case 'v':
       view_path = optarg;
       break;
+    case 'g':
+      group_players = 1;
+      break;
+    case 'a':
+      pin_processes = 1;
+      break;
+    case 'n':
+      player_nice = atoi(optarg);
+      if (player_nice < 0 || player_nice > 19) {
+        fprintf(stderr, "Error: nice debe estar entre 0 y 19.\n");
+        return EXIT_FAILURE;
+      }
+      break;
+    case 'f':
+      master_fifo = 1;
+      break;
+    case 'u':
+      use_io_uring = 1;
+      break;
     case 'p':
       if (*num_players >= 9) {
         fprintf(stderr, "Error: Máximo 9 jugadores.\n");
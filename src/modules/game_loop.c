@@ -1,17 +1,80 @@
 // This is a personal academic project. Dear PVS-Studio, please check it.
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#ifdef __linux__
+#define _GNU_SOURCE // syscall(SYS_pidfd_open)
+#include <sys/syscall.h>
+#endif
 #include "../include/game_loop.h"
 #include "../include/config.h"
 #include "../include/game_logic.h"
 #include "../include/ipc_communication.h"
 #include "../include/memory.h"
+#include "../include/player_io.h"
 #include <errno.h>
-#include <poll.h>
+#include <math.h>
 #include <stdio.h>
 #include <time.h>
 #include <unistd.h>
 
-void run_game_loop(int num_players, pid_t view_pid) {
+// Retraso de cada despertar del tick respecto de lo pedido a nanosleep, en
+// microsegundos: mide cuánto tarda el planificador en devolver la CPU al
+// máster
+static struct {
+  long count;
+  double sum, sumsq, max;
+} tick_jitter;
+
+static double monotonic_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
+}
+
+// pidfd del proceso: se vuelve legible cuando termina (Linux >= 5.3); -1 si
+// no hay soporte, y entonces solo se detecta por el cierre del pipe
+static int open_pidfd(pid_t pid) {
+#ifdef SYS_pidfd_open
+  return (int)syscall(SYS_pidfd_open, pid, 0);
+#else
+  (void)pid;
+  return -1;
+#endif
+}
+
+// Un proceso de jugadores terminó: bloquear sus asientos y liberar los
+// lugares de lector que tuviera tomados en el lock del estado
+static void player_process_died(int num_players, pid_t player_pids[],
+                                pid_t pid) {
+  int held = lock_state_write();
+  for (int i = 0; i < num_players; i++) {
+    if (player_pids[i] == pid && !game_state->players[i].blocked) {
+      game_state->players[i].blocked = 1;
+      fprintf(stderr, "Jugador %c terminó inesperadamente\n", 'A' + i);
+    }
+  }
+  unlock_state_write(held);
+  game_lock_reap(game_state_lock, pid);
+}
+
+void print_tick_jitter(void) {
+  if (tick_jitter.count == 0)
+    return;
+  double mean = tick_jitter.sum / (double)tick_jitter.count;
+  double var = tick_jitter.sumsq / (double)tick_jitter.count - mean * mean;
+  printf("Jitter del tick: %ld ticks | retraso medio %.1f us | desvío %.1f us "
+         "| máximo %.1f us\n",
+         tick_jitter.count, mean, sqrt(var > 0.0 ? var : 0.0),
+         tick_jitter.max);
+}
+
+void run_game_loop(int num_players, pid_t player_pids[], pid_t view_pid) {
+  // Un pidfd por proceso de jugadores (el primer asiento de cada grupo)
+  int pidfds[9] = {-1, -1, -1, -1, -1, -1, -1, -1, -1};
+  for (int i = 0; i < num_players; i++) {
+    if (i == 0 || player_pids[i] != player_pids[i - 1])
+      pidfds[i] = open_pidfd(player_pids[i]);
+  }
+  player_io_open(num_players, pidfds);
   // Loop principal del juego
   unsigned long long last_valid_move_ms = current_millis();
   const unsigned long long INACTIVITY_TIMEOUT_MS =
@@ -32,17 +95,8 @@ void run_game_loop(int num_players, pid_t view_pid) {
       sem_post(&game_semaphores->game_players_sem[i]);
     }
     // Leer sin bloquear del pipe de cada jugador
-
-    struct pollfd pfds[9];
-    int nfds = 0;
-    for (int k = 0; k < num_players; k++) {
-      int i = (next_rr_index + k) % num_players;
-      pfds[i].fd = player_pipes[i][0];
-      pfds[i].events = POLLIN;
-      pfds[i].revents = 0;
-    }
-    nfds = num_players;
-    int pret = poll(pfds, nfds, 50); // esperar hasta 50ms por datos
+    int events[9];
+    int pret = player_io_wait(events, 50); // esperar hasta 50ms por datos
     if (pret > 0) {
       int last_processed = -1;
       // Atender en orden round-robin comenzando desde next_rr_index
@@ -50,21 +104,19 @@ void run_game_loop(int num_players, pid_t view_pid) {
         int i = (next_rr_index + k) % num_players;
         if (game_state->players[i].blocked)
           continue;
-        if (pfds[i].revents & POLLIN) {
+        if (events[i] & PLAYER_IO_READABLE) {
           unsigned char move_byte;
-          ssize_t r = read(player_pipes[i][0], &move_byte, 1);
+          ssize_t r = player_io_read(i, &move_byte);
           if (r >= 1) {
             int direction = (int)move_byte;
             // Exclusión mutua de escritura del estado del juego (RW-lock)
-            sem_wait(&game_semaphores->game_master_mutex);
-            sem_wait(&game_semaphores->game_state_mutex);
+            int held = lock_state_write();
             unsigned int prev_valid = game_state->players[i].validMove;
             apply_player_move(i, direction);
             if (game_state->players[i].validMove != prev_valid) {
               last_valid_move_ms = current_millis();
             }
-            sem_post(&game_semaphores->game_state_mutex);
-            sem_post(&game_semaphores->game_master_mutex);
+            unlock_state_write(held);
             last_processed = i;
           } else if (r == 0) {
             // EOF: jugador sin más movimientos -> bloquear
@@ -79,7 +131,7 @@ void run_game_loop(int num_players, pid_t view_pid) {
             }
           }
         }
-        if (pfds[i].revents & (POLLHUP | POLLERR | POLLNVAL)) {
+        if (events[i] & PLAYER_IO_HANGUP) {
           // Pipe cerrado o error: considerar bloqueado
           game_state->players[i].blocked = 1;
         }
@@ -87,6 +139,14 @@ void run_game_loop(int num_players, pid_t view_pid) {
       if (last_processed != -1) {
         next_rr_index = (last_processed + 1) % num_players;
       }
+      // Procesos de jugadores que terminaron (normal o por un fallo)
+      for (int i = 0; i < num_players; i++) {
+        if (events[i] & PLAYER_IO_DIED) {
+          player_process_died(num_players, player_pids, player_pids[i]);
+          close(pidfds[i]);
+          pidfds[i] = -1;
+        }
+      }
     }
 
     // Señalar a la vista que actualice (solo si hay vista)
@@ -100,7 +160,17 @@ void run_game_loop(int num_players, pid_t view_pid) {
     // Pequeño respiro para no saturar CPU y dar tiempo a jugadores
     {
       struct timespec ts = {0, 500000000};
-      nanosleep(&ts, NULL);
+      double t0 = monotonic_us();
+      if (nanosleep(&ts, NULL) == 0) {
+        double late = monotonic_us() - t0 - 500000.0;
+        if (late < 0.0)
+          late = 0.0;
+        tick_jitter.count++;
+        tick_jitter.sum += late;
+        tick_jitter.sumsq += late * late;
+        if (late > tick_jitter.max)
+          tick_jitter.max = late;
+      }
     } // 500ms
 
     // Timeout por inactividad de movimientos válidos
@@ -138,4 +208,8 @@ void run_game_loop(int num_players, pid_t view_pid) {
       }
     }
   }
+  player_io_close();
+  for (int i = 0; i < num_players; i++)
+    if (pidfds[i] >= 0)
+      close(pidfds[i]);
 }
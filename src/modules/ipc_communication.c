@@ -1,5 +1,9 @@
 // This is a personal academic project. Dear PVS-Studio, please check it.
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#ifdef __linux__
+#define _GNU_SOURCE // sched_setaffinity y cpu_set_t
+#include <sched.h>
+#endif
 #include "../include/ipc_communication.h"
 #include "../include/config.h"
 #include "../include/memory.h"
@@ -7,6 +11,7 @@
 #include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/resource.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
@@ -15,6 +20,128 @@ extern char **environ;
 // Variables globales de comunicación
 int player_pipes[9][2];
 
+// Ubicación de procesos (-a, -n, -f). placement_cpus guarda las CPUs para
+// los jugadores: primero un hilo de cada núcleo físico distinto del del
+// máster, después los hermanos SMT y por último los del núcleo del máster.
+// Cada asiento ocupa un lugar; la vista, que casi siempre duerme, comparte el
+// último lugar en vez de quitarle un núcleo a un jugador.
+#ifdef __linux__
+static int placement_cpus[CPU_SETSIZE];
+#else
+static int placement_cpus[1];
+#endif
+static int placement_count = 0;
+static int placement_next = 0; // próximo lugar libre para un jugador
+
+#ifdef __linux__
+// Identificador de núcleo físico (paquete y núcleo) según sysfs; cada CPU
+// cuenta como núcleo propio si no hay topología
+static long core_key(int cpu) {
+  char path[96];
+  long pkg = cpu, core = 0;
+  FILE *f;
+  snprintf(path, sizeof(path),
+           "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+  if ((f = fopen(path, "r"))) {
+    if (fscanf(f, "%ld", &pkg) != 1)
+      pkg = cpu;
+    fclose(f);
+  }
+  snprintf(path, sizeof(path),
+           "/sys/devices/system/cpu/cpu%d/topology/core_id", cpu);
+  if ((f = fopen(path, "r"))) {
+    if (fscanf(f, "%ld", &core) != 1)
+      core = 0;
+    fclose(f);
+  } else {
+    return -1 - cpu;
+  }
+  return pkg * 65536 + core;
+}
+
+// Fija el proceso a los lugares first .. first + slots - 1 del reparto
+static void pin_to_slots(pid_t pid, int first, int slots) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int k = 0; k < slots; k++)
+    CPU_SET(placement_cpus[(first + k) % placement_count], &set);
+  if (sched_setaffinity(pid, sizeof(set), &set) == -1)
+    perror("sched_setaffinity");
+}
+#endif
+
+void placement_init(void) {
+#ifdef __linux__
+  if (pin_processes) {
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == -1) {
+      perror("sched_getaffinity");
+    } else {
+      int cpus[CPU_SETSIZE], n = 0;
+      for (int c = 0; c < CPU_SETSIZE; c++)
+        if (CPU_ISSET(c, &allowed))
+          cpus[n++] = c;
+      long master_core = core_key(cpus[0]);
+      cpu_set_t own;
+      CPU_ZERO(&own);
+      CPU_SET(cpus[0], &own);
+      if (sched_setaffinity(0, sizeof(own), &own) == -1)
+        perror("sched_setaffinity");
+      // Tres pasadas: un hilo por núcleo libre, el resto de sus hermanos SMT
+      // y por último los hermanos del máster
+      long key[CPU_SETSIZE];
+      char taken[CPU_SETSIZE] = {0};
+      for (int i = 1; i < n; i++)
+        key[i] = core_key(cpus[i]);
+      for (int pass = 0; pass < 3; pass++) {
+        for (int i = 1; i < n; i++) {
+          if (taken[i] || (pass < 2) != (key[i] != master_core))
+            continue;
+          int first = 1;
+          for (int j = 1; j < i && first; j++)
+            first = key[j] != key[i];
+          if (pass == 0 && !first)
+            continue;
+          taken[i] = 1;
+          placement_cpus[placement_count++] = cpus[i];
+        }
+      }
+      // Con una sola CPU no hay dónde apartar al máster
+      if (placement_count == 0)
+        placement_cpus[placement_count++] = cpus[0];
+    }
+  }
+  if (master_fifo) {
+    struct sched_param sp = {.sched_priority = 1};
+    if (sched_setscheduler(0, SCHED_FIFO, &sp) == -1)
+      perror("sched_setscheduler SCHED_FIFO (se sigue sin tiempo real)");
+  }
+#else
+  if (pin_processes || master_fifo)
+    fprintf(stderr, "Aviso: -a y -f solo están disponibles en Linux\n");
+#endif
+}
+
+// Se llama en el hijo antes de execve: `slots` lugares del reparto desde
+// `first` (uno por asiento, así un proceso con varios asientos no busca con
+// todos en un mismo núcleo) y nice. Los hijos no heredan SCHED_FIFO del
+// máster.
+static void placement_apply_child(int first, int slots) {
+#ifdef __linux__
+  if (master_fifo) {
+    struct sched_param sp = {.sched_priority = 0};
+    sched_setscheduler(0, SCHED_OTHER, &sp);
+  }
+  if (placement_count > 0)
+    pin_to_slots(0, first, slots < placement_count ? slots : placement_count);
+#else
+  (void)first;
+  (void)slots;
+#endif
+  if (player_nice > 0 && setpriority(PRIO_PROCESS, 0, player_nice) == -1)
+    perror("setpriority");
+}
+
 // Función para crear pipes de comunicación
 int create_player_pipes() {
   for (int i = 0; i < (int)game_state->cantPlayers; i++) {
@@ -49,6 +176,7 @@ pid_t create_view_process(int width, int height) {
     snprintf(width_str, sizeof(width_str), "%d", width);
     snprintf(height_str, sizeof(height_str), "%d", height);
 
+    placement_apply_child(placement_count - 1, 1);
     char *args[] = {"view", width_str, height_str, NULL};
     execve(view_path, args, environ);
     perror("execve view");
@@ -58,8 +186,12 @@ pid_t create_view_process(int width, int height) {
   return view_pid;
 }
 
-// Función para crear procesos de jugadores
-pid_t create_player_process(const char *player_executable, int pipe_fd) {
+// Función para crear el proceso de los jugadores first_seat ..
+// first_seat + seats - 1. El primero escribe por stdout y el k-ésimo (k >= 1)
+// por el descriptor PLAYER_SEAT_FD(k); con más de un asiento la cantidad se
+// pasa como tercer argumento.
+pid_t create_player_process(const char *player_executable, int first_seat,
+                            int seats) {
   pid_t player_pid = fork();
 
   if (player_pid == -1) {
@@ -69,33 +201,54 @@ pid_t create_player_process(const char *player_executable, int pipe_fd) {
 
   if (player_pid == 0) {
     // Proceso hijo
-    // Cerrar todos los extremos de pipes que no se usen en este proceso
-    for (int i = 0; i < 9; i++) {
-      if (player_pipes[i][0] != pipe_fd) {
-        close(player_pipes[i][0]);
+    // Duplicar los extremos de escritura propios por encima de los destinos
+    // para que dup2 no pise ninguno todavía no movido
+    int fds[9];
+    for (int k = 0; k < seats; k++) {
+      fds[k] = fcntl(player_pipes[first_seat + k][1], F_DUPFD,
+                     PLAYER_SEAT_FD(seats));
+      if (fds[k] == -1) {
+        perror("fcntl player pipe");
+        exit(EXIT_FAILURE);
       }
-      if (player_pipes[i][1] != pipe_fd) {
-        close(player_pipes[i][1]);
+    }
+    // Cerrar todos los extremos de pipes originales. Los de escritura de
+    // grupos anteriores ya se cerraron en el padre y su número pudo ser
+    // reutilizado por una de las copias
+    for (int i = 0; i < 9; i++) {
+      for (int e = 0; e < 2; e++) {
+        int fd = player_pipes[i][e], ours = 0;
+        for (int k = 0; k < seats; k++)
+          ours |= fds[k] == fd;
+        if (!ours)
+          close(fd);
       }
     }
-    // Redirigir stdout del jugador al extremo de escritura del pipe
-    if (dup2(pipe_fd, STDOUT_FILENO) == -1) {
-      perror("dup2 player stdout");
-      exit(EXIT_FAILURE);
+    // Redirigir stdout del jugador al pipe de su primer asiento y el resto a
+    // descriptores consecutivos
+    for (int k = 0; k < seats; k++) {
+      int target = k == 0 ? STDOUT_FILENO : PLAYER_SEAT_FD(k);
+      if (dup2(fds[k], target) == -1) {
+        perror("dup2 player pipe");
+        exit(EXIT_FAILURE);
+      }
+      close(fds[k]);
     }
-    // Cerrar descriptor de escritura (ya duplicado)
-    close(pipe_fd);
 
     // Pasar ancho y alto como argumentos (compatible con player_cente)
-    char width_str[16], height_str[16];
+    char width_str[16], height_str[16], seats_str[16];
     snprintf(width_str, sizeof(width_str), "%d", (int)game_state->width);
     snprintf(height_str, sizeof(height_str), "%d", (int)game_state->height);
+    snprintf(seats_str, sizeof(seats_str), "%d", seats);
 
-    char *args[] = {(char *)player_executable, width_str, height_str, NULL};
+    placement_apply_child(placement_next, seats);
+    char *args[] = {(char *)player_executable, width_str, height_str,
+                    seats > 1 ? seats_str : NULL, NULL};
     execve(player_executable, args, environ);
     perror("execve player");
     exit(EXIT_FAILURE);
   }
 
+  placement_next += seats;
   return player_pid;
 }
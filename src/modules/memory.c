@@ -5,13 +5,23 @@
 #include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <semaphore.h>
 #include <sys/mman.h>
+#include <time.h>
 #include <unistd.h>
 
+// Espera máxima por C y D: solo los usan lectores del protocolo anterior, y
+// uno que muera con ellos tomados no debe colgar al máster
+#define LEGACY_LOCK_WAIT_NS 50000000L
+#define HELD_MASTER_MUTEX 1
+#define HELD_STATE_MUTEX 2
+#define HELD_STATE_LOCK 4
+
 // Variables globales de memoria
 int game_shm_fd, sem_shm_fd;
 game *game_state;
 semaphore_struct *game_semaphores;
+game_lock *game_state_lock;
 
 // Función para crear memoria compartida del juego
 int create_game_shared_memory(int width, int height, int num_players) {
@@ -96,9 +106,48 @@ int create_semaphore_shared_memory() {
       return -1;
     }
   }
+  // Lock robusto del estado, en su propio segmento
+  game_state_lock = create_game_lock();
+  if (game_state_lock == NULL)
+    return -1;
+  return 0;
+}
+
+static int timed_sem_wait(sem_t *sem) {
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  ts.tv_nsec += LEGACY_LOCK_WAIT_NS;
+  if (ts.tv_nsec >= 1000000000L) {
+    ts.tv_sec++;
+    ts.tv_nsec -= 1000000000L;
+  }
+  while (sem_timedwait(sem, &ts) == -1) {
+    if (errno != EINTR)
+      return -1;
+  }
   return 0;
 }
 
+int lock_state_write(void) {
+  int held = 0;
+  if (timed_sem_wait(&game_semaphores->game_master_mutex) == 0)
+    held |= HELD_MASTER_MUTEX;
+  if (timed_sem_wait(&game_semaphores->game_state_mutex) == 0)
+    held |= HELD_STATE_MUTEX;
+  if (game_lock_write_acquire(game_state_lock) == 0)
+    held |= HELD_STATE_LOCK;
+  return held;
+}
+
+void unlock_state_write(int held) {
+  if (held & HELD_STATE_LOCK)
+    game_lock_write_release(game_state_lock);
+  if (held & HELD_STATE_MUTEX)
+    sem_post(&game_semaphores->game_state_mutex);
+  if (held & HELD_MASTER_MUTEX)
+    sem_post(&game_semaphores->game_master_mutex);
+}
+
 void cleanup_memory(int width, int height) {
   // Destruir semáforos antes de liberar el segmento que los contiene
   if (game_semaphores && game_semaphores != MAP_FAILED) {
@@ -112,6 +161,8 @@ void cleanup_memory(int width, int height) {
     }
     munmap(game_semaphores, sizeof(semaphore_struct));
   }
+  destroy_game_lock(game_state_lock);
+  game_state_lock = NULL;
 
   // Liberar memoria compartida del juego (no hay que liberar playerName: es un array fijo)
   size_t game_size = sizeof(game) + (width * height * sizeof(int));
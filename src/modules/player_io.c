@@ -0,0 +1,454 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#ifdef __linux__
+#define _GNU_SOURCE // syscall()
+#include <sys/syscall.h>
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup)
+#define PLAYER_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#endif
+#endif
+#endif
+#include "../include/player_io.h"
+#include "../include/config.h"
+#include "../include/ipc_communication.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static int io_players = 0;
+static int io_pidfds[9];
+static int io_uring_active = 0;
+static const char *io_backend = "poll";
+// Contadores para print_player_io_stats: solo las llamadas de lectura (poll,
+// read, io_uring_enter); no cuentan los sem_post, el lock ni el nanosleep
+static long io_read_syscalls = 0;
+static long io_moves = 0;
+
+// ---------------------------------------------------------------------------
+// Backend poll: un poll por espera y un read por byte
+// ---------------------------------------------------------------------------
+
+static int poll_wait(int events[], int timeout_ms) {
+  // Después de los pipes, los pidfd: poll ignora los fd negativos
+  struct pollfd pfds[18];
+  for (int i = 0; i < io_players; i++) {
+    pfds[i].fd = player_pipes[i][0];
+    pfds[i].events = POLLIN;
+    pfds[i].revents = 0;
+    pfds[io_players + i].fd = io_pidfds[i];
+    pfds[io_players + i].events = POLLIN;
+    pfds[io_players + i].revents = 0;
+  }
+  io_read_syscalls++;
+  int pret = poll(pfds, (nfds_t)(2 * io_players), timeout_ms);
+  if (pret <= 0)
+    return pret;
+  int ready = 0;
+  for (int i = 0; i < io_players; i++) {
+    events[i] = 0;
+    if (pfds[i].revents & POLLIN)
+      events[i] |= PLAYER_IO_READABLE;
+    if (pfds[i].revents & (POLLHUP | POLLERR | POLLNVAL))
+      events[i] |= PLAYER_IO_HANGUP;
+    if (pfds[io_players + i].revents & POLLIN) {
+      events[i] |= PLAYER_IO_DIED;
+      io_pidfds[i] = -1;
+    }
+    ready += events[i] != 0;
+  }
+  return ready;
+}
+
+#ifdef PLAYER_IO_URING
+// ---------------------------------------------------------------------------
+// Backend io_uring. Una lectura multishot por pipe deja cada byte recibido en
+// un buffer del anillo registrado y publica la completion sin que el máster
+// haga ninguna llamada; los bytes se copian a una cola por jugador y el
+// buffer vuelve al anillo. Solo se entra al kernel para esperar con el anillo
+// vacío (con un IORING_OP_TIMEOUT como plazo) o para rearmar una lectura.
+// ---------------------------------------------------------------------------
+
+#define URING_ENTRIES 32
+#define URING_BUFS 64 // potencia de 2
+#define URING_BUF_SIZE 32
+#define URING_BGID 0
+#define URING_QUEUE 256 // bytes pendientes por jugador
+// IORING_OP_READ_MULTISHOT (Linux 6.7); los headers anteriores no lo declaran
+#define URING_OP_READ_MULTISHOT 49
+// user_data: tipo en el segundo byte y jugador en el primero
+#define URING_TAG_READ 1
+#define URING_TAG_PIDFD 2
+#define URING_TAG_TIMEOUT 3
+
+static struct {
+  int fd;
+  unsigned *sq_head, *sq_tail, *sq_mask, *sq_array, *sq_flags;
+  unsigned *cq_head, *cq_tail, *cq_mask;
+  struct io_uring_sqe *sqes;
+  struct io_uring_cqe *cqes;
+  void *sq_ring, *cq_ring;
+  size_t sq_ring_size, cq_ring_size, sqes_size;
+  unsigned to_submit;
+  struct io_uring_buf_ring *br;
+  unsigned char bufs[URING_BUFS][URING_BUF_SIZE];
+  unsigned short br_tail;
+  struct __kernel_timespec deadline;
+  unsigned char queue[9][URING_QUEUE];
+  int q_head[9], q_count[9];
+  int eof[9];  // EOF o error: no hay más lecturas armadas
+  int died[9]; // pidfd legible todavía no informado
+} ring;
+
+static int uring_enter(unsigned to_submit, unsigned min_complete,
+                       unsigned flags) {
+  io_read_syscalls++;
+  return (int)syscall(__NR_io_uring_enter, ring.fd, to_submit, min_complete,
+                      flags, NULL, 0);
+}
+
+static struct io_uring_sqe *uring_sqe(void) {
+  unsigned tail = *ring.sq_tail;
+  if (tail - __atomic_load_n(ring.sq_head, __ATOMIC_ACQUIRE) >= URING_ENTRIES)
+    return NULL;
+  unsigned idx = tail & *ring.sq_mask;
+  struct io_uring_sqe *sqe = &ring.sqes[idx];
+  memset(sqe, 0, sizeof(*sqe));
+  ring.sq_array[idx] = idx;
+  __atomic_store_n(ring.sq_tail, tail + 1, __ATOMIC_RELEASE);
+  ring.to_submit++;
+  return sqe;
+}
+
+static void uring_give_buffer(unsigned short bid) {
+  struct io_uring_buf *b = &ring.br->bufs[ring.br_tail & (URING_BUFS - 1)];
+  b->addr = (unsigned long)ring.bufs[bid];
+  b->len = URING_BUF_SIZE;
+  b->bid = bid;
+  ring.br_tail++;
+  __atomic_store_n(&ring.br->tail, ring.br_tail, __ATOMIC_RELEASE);
+}
+
+static void uring_arm_read(int i) {
+  struct io_uring_sqe *sqe = uring_sqe();
+  if (!sqe) {
+    ring.eof[i] = 1;
+    return;
+  }
+  sqe->opcode = URING_OP_READ_MULTISHOT;
+  sqe->fd = player_pipes[i][0];
+  sqe->flags = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = URING_BGID;
+  sqe->user_data = (URING_TAG_READ << 8) | (unsigned)i;
+}
+
+static void uring_arm_pidfd(int i) {
+  struct io_uring_sqe *sqe = uring_sqe();
+  if (!sqe)
+    return;
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = io_pidfds[i];
+  sqe->poll32_events = POLLIN;
+  sqe->user_data = (URING_TAG_PIDFD << 8) | (unsigned)i;
+}
+
+static void uring_close(void) {
+  if (ring.cq_ring && ring.cq_ring != ring.sq_ring)
+    munmap(ring.cq_ring, ring.cq_ring_size);
+  if (ring.sq_ring)
+    munmap(ring.sq_ring, ring.sq_ring_size);
+  if (ring.sqes)
+    munmap(ring.sqes, ring.sqes_size);
+  if (ring.br)
+    munmap(ring.br, URING_BUFS * sizeof(struct io_uring_buf));
+  if (ring.fd >= 0)
+    close(ring.fd);
+  memset(&ring, 0, sizeof(ring));
+  ring.fd = -1;
+}
+
+// 0 si el anillo quedó listo; -1 (con el motivo en stderr) para volver a poll
+static int uring_open(void) {
+  memset(&ring, 0, sizeof(ring));
+  struct io_uring_params p;
+  memset(&p, 0, sizeof(p));
+  p.flags = IORING_SETUP_COOP_TASKRUN | IORING_SETUP_SINGLE_ISSUER;
+  ring.fd = (int)syscall(__NR_io_uring_setup, URING_ENTRIES, &p);
+  if (ring.fd < 0 && errno == EINVAL) {
+    // Kernel anterior a 6.0: sin esas optimizaciones
+    memset(&p, 0, sizeof(p));
+    ring.fd = (int)syscall(__NR_io_uring_setup, URING_ENTRIES, &p);
+  }
+  if (ring.fd < 0) {
+    perror("io_uring_setup");
+    return -1;
+  }
+
+  ring.sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  ring.cq_ring_size =
+      p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  if (p.features & IORING_FEAT_SINGLE_MMAP) {
+    if (ring.cq_ring_size > ring.sq_ring_size)
+      ring.sq_ring_size = ring.cq_ring_size;
+  }
+  ring.sq_ring = mmap(NULL, ring.sq_ring_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQ_RING);
+  if (ring.sq_ring == MAP_FAILED) {
+    ring.sq_ring = NULL;
+    perror("mmap io_uring");
+    uring_close();
+    return -1;
+  }
+  if (p.features & IORING_FEAT_SINGLE_MMAP) {
+    ring.cq_ring = ring.sq_ring;
+  } else {
+    ring.cq_ring = mmap(NULL, ring.cq_ring_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_CQ_RING);
+    if (ring.cq_ring == MAP_FAILED) {
+      ring.cq_ring = NULL;
+      perror("mmap io_uring");
+      uring_close();
+      return -1;
+    }
+  }
+  ring.sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+  ring.sqes = mmap(NULL, ring.sqes_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQES);
+  if (ring.sqes == MAP_FAILED) {
+    ring.sqes = NULL;
+    perror("mmap io_uring");
+    uring_close();
+    return -1;
+  }
+  char *sq = (char *)ring.sq_ring, *cq = (char *)ring.cq_ring;
+  ring.sq_head = (unsigned *)(sq + p.sq_off.head);
+  ring.sq_tail = (unsigned *)(sq + p.sq_off.tail);
+  ring.sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+  ring.sq_array = (unsigned *)(sq + p.sq_off.array);
+  ring.sq_flags = (unsigned *)(sq + p.sq_off.flags);
+  ring.cq_head = (unsigned *)(cq + p.cq_off.head);
+  ring.cq_tail = (unsigned *)(cq + p.cq_off.tail);
+  ring.cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+  ring.cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+  // Las lecturas multishot necesitan Linux 6.7
+  struct io_uring_probe *probe = (struct io_uring_probe *)calloc(
+      1, sizeof(*probe) + 64 * sizeof(struct io_uring_probe_op));
+  int multishot =
+      probe &&
+      syscall(__NR_io_uring_register, ring.fd, IORING_REGISTER_PROBE, probe,
+              64) == 0 &&
+      probe->ops_len > URING_OP_READ_MULTISHOT &&
+      (probe->ops[URING_OP_READ_MULTISHOT].flags & IO_URING_OP_SUPPORTED);
+  free(probe);
+  if (!multishot) {
+    fprintf(stderr, "io_uring sin lecturas multishot\n");
+    uring_close();
+    return -1;
+  }
+
+  // Anillo de buffers provistos (Linux 5.19), alineado a página
+  ring.br = mmap(NULL, URING_BUFS * sizeof(struct io_uring_buf),
+                 PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ring.br == MAP_FAILED) {
+    ring.br = NULL;
+    perror("mmap io_uring buffers");
+    uring_close();
+    return -1;
+  }
+  struct io_uring_buf_reg reg;
+  memset(&reg, 0, sizeof(reg));
+  reg.ring_addr = (unsigned long)ring.br;
+  reg.ring_entries = URING_BUFS;
+  reg.bgid = URING_BGID;
+  if (syscall(__NR_io_uring_register, ring.fd, IORING_REGISTER_PBUF_RING, &reg,
+              1) < 0) {
+    perror("io_uring_register PBUF_RING");
+    uring_close();
+    return -1;
+  }
+  for (unsigned short b = 0; b < URING_BUFS; b++)
+    uring_give_buffer(b);
+
+  // Con O_NONBLOCK io_uring completa con -EAGAIN en vez de esperar datos; en
+  // este modo el máster nunca hace read() sobre los pipes
+  for (int i = 0; i < io_players; i++) {
+    int flags = fcntl(player_pipes[i][0], F_GETFL, 0);
+    if (flags != -1)
+      fcntl(player_pipes[i][0], F_SETFL, flags & ~O_NONBLOCK);
+    uring_arm_read(i);
+    if (io_pidfds[i] >= 0)
+      uring_arm_pidfd(i);
+  }
+  return 0;
+}
+
+static void uring_push(int i, const unsigned char *data, int n) {
+  for (int k = 0; k < n; k++) {
+    // Un jugador que escribe mucho más de lo que se consume pierde el resto
+    if (ring.q_count[i] == URING_QUEUE)
+      return;
+    ring.queue[i][(ring.q_head[i] + ring.q_count[i]) % URING_QUEUE] = data[k];
+    ring.q_count[i]++;
+  }
+}
+
+static void uring_reap(void) {
+  unsigned head = *ring.cq_head;
+  unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+  for (; head != tail; head++) {
+    const struct io_uring_cqe *cqe = &ring.cqes[head & *ring.cq_mask];
+    int tag = (int)(cqe->user_data >> 8);
+    int i = (int)(cqe->user_data & 0xff);
+    if (tag == URING_TAG_READ) {
+      if (cqe->flags & IORING_CQE_F_BUFFER) {
+        unsigned short bid =
+            (unsigned short)(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+        if (cqe->res > 0)
+          uring_push(i, ring.bufs[bid], cqe->res);
+        uring_give_buffer(bid);
+      }
+      if (!(cqe->flags & IORING_CQE_F_MORE)) {
+        // Terminó la lectura multishot: rearmar salvo EOF o error
+        if (cqe->res > 0 || cqe->res == -ENOBUFS)
+          uring_arm_read(i);
+        else
+          ring.eof[i] = 1;
+      }
+    } else if (tag == URING_TAG_PIDFD && cqe->res > 0) {
+      ring.died[i] = 1;
+    }
+  }
+  __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+}
+
+static int uring_events(int events[]) {
+  int ready = 0;
+  for (int i = 0; i < io_players; i++) {
+    events[i] = 0;
+    if (ring.q_count[i] > 0)
+      events[i] |= PLAYER_IO_READABLE;
+    if (ring.eof[i])
+      events[i] |= PLAYER_IO_HANGUP;
+    if (ring.died[i]) {
+      events[i] |= PLAYER_IO_DIED;
+      ring.died[i] = 0;
+      io_pidfds[i] = -1;
+    }
+    ready += events[i] != 0;
+  }
+  return ready;
+}
+
+static int uring_wait(int events[], int timeout_ms) {
+  uring_reap();
+  int ready = uring_events(events);
+  unsigned overflow =
+      __atomic_load_n(ring.sq_flags, __ATOMIC_RELAXED) & IORING_SQ_CQ_OVERFLOW;
+  if (ready > 0 && ring.to_submit == 0 && !overflow)
+    return ready;
+  unsigned min_complete = 0, flags = 0;
+  if (ready == 0 && timeout_ms > 0) {
+    // Plazo del tick: el timeout se completa solo al vencer o en cuanto
+    // llegue otra completion
+    struct io_uring_sqe *sqe = uring_sqe();
+    if (sqe) {
+      ring.deadline.tv_sec = timeout_ms / 1000;
+      ring.deadline.tv_nsec = (long long)(timeout_ms % 1000) * 1000000LL;
+      sqe->opcode = IORING_OP_TIMEOUT;
+      sqe->fd = -1;
+      sqe->addr = (unsigned long)&ring.deadline;
+      sqe->len = 1;
+      sqe->off = 1;
+      sqe->user_data = URING_TAG_TIMEOUT << 8;
+      min_complete = 1;
+      flags = IORING_ENTER_GETEVENTS;
+    }
+  }
+  if (overflow)
+    flags |= IORING_ENTER_GETEVENTS;
+  int rc = uring_enter(ring.to_submit, min_complete, flags);
+  if (rc < 0 && errno != EINTR && errno != ETIME)
+    return -1;
+  if (rc > 0)
+    ring.to_submit -= (unsigned)rc;
+  uring_reap();
+  return uring_events(events);
+}
+
+static ssize_t uring_read(int i, unsigned char *byte) {
+  if (ring.q_count[i] > 0) {
+    *byte = ring.queue[i][ring.q_head[i]];
+    ring.q_head[i] = (ring.q_head[i] + 1) % URING_QUEUE;
+    ring.q_count[i]--;
+    return 1;
+  }
+  if (ring.eof[i])
+    return 0;
+  errno = EAGAIN;
+  return -1;
+}
+#endif // PLAYER_IO_URING
+
+// ---------------------------------------------------------------------------
+
+void player_io_open(int num_players, const int pidfds[]) {
+  io_players = num_players;
+  for (int i = 0; i < num_players; i++)
+    io_pidfds[i] = pidfds[i];
+  io_uring_active = 0;
+  if (!use_io_uring)
+    return;
+#ifdef PLAYER_IO_URING
+  io_uring_active = uring_open() == 0;
+#endif
+  if (io_uring_active)
+    io_backend = "io_uring";
+  else
+    fprintf(stderr, "Aviso: io_uring no disponible, se usa poll\n");
+}
+
+void player_io_close(void) {
+#ifdef PLAYER_IO_URING
+  if (io_uring_active)
+    uring_close();
+#endif
+  io_uring_active = 0;
+}
+
+int player_io_wait(int events[], int timeout_ms) {
+#ifdef PLAYER_IO_URING
+  if (io_uring_active)
+    return uring_wait(events, timeout_ms);
+#endif
+  return poll_wait(events, timeout_ms);
+}
+
+ssize_t player_io_read(int player, unsigned char *byte) {
+  ssize_t r;
+#ifdef PLAYER_IO_URING
+  if (io_uring_active)
+    r = uring_read(player, byte);
+  else
+#endif
+  {
+    io_read_syscalls++;
+    r = read(player_pipes[player][0], byte, 1);
+  }
+  if (r == 1)
+    io_moves++;
+  return r;
+}
+
+void print_player_io_stats(void) {
+  printf("Lectura de jugadores (%s): %ld llamadas al sistema de lectura | "
+         "%ld movimientos | %.2f llamadas de lectura por movimiento\n",
+         io_backend, io_read_syscalls, io_moves,
+         io_moves > 0 ? (double)io_read_syscalls / (double)io_moves : 0.0);
+}
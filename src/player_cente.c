@@ -1,85 +1,246 @@
 // This is a personal academic project. Dear PVS-Studio, please check it.
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
-#include "include/cente_autotune.h"
 #include "include/cente_board.h"
 #include "include/cente_config.h"
+#include "include/cente_engine.h"
 #include "include/cente_eval.h"
-#include "include/cente_influence.h"
-#include "include/cente_mcts.h"
+#include "include/cente_kernels.h"
+#include "include/cente_rollout.h"
+#include "include/cente_zobrist.h"
 #include "include/game.h"
 #include "include/game_semaphore.h"
 #include "include/ipc.h"
+#include "include/ipc_communication.h"
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <unistd.h>
-#include <math.h>
 
-static int choose_cente_move(game *gs, semaphore_struct *sem_state,
-                             int player_id) {
-  (void)sem_state;
-  int w = gs->width, h = gs->height, P = (int)gs->cantPlayers;
+// Seat lookup: the master registers our pid right after the fork, so poll
+// for it a while instead of giving up on the first misses
+#define SEAT_LOOKUP_TRIES 2000
+#define SEAT_LOOKUP_SLEEP_NS 1000000L
+
+// Per-player fields copied under the read lock; the board itself is synced
+// into the engine's private copy (see engine_sync)
+typedef struct {
+  int num_players;
   unsigned short hx[CENTE_MAX_PLAYERS];
   unsigned short hy[CENTE_MAX_PLAYERS];
   unsigned char blocked[CENTE_MAX_PLAYERS];
   unsigned int score[CENTE_MAX_PLAYERS];
+  unsigned int valid[CENTE_MAX_PLAYERS];
+  unsigned int invalid[CENTE_MAX_PLAYERS];
+} cente_snapshot;
+
+// State shared by the seats this process serves (see master -g). With more
+// than one seat the first to wake each tick copies the board into `cells`
+// and the others sync from that copy; with one seat the engine syncs straight
+// from shared memory as before.
+typedef struct {
+  game *gs;
+  semaphore_struct *sem;
+  int *cells;          // tick copy of the board, NULL with a single seat
+  cente_snapshot tick; // players at the time of that copy
+  int have_tick;
+  pthread_mutex_t lock; // guards the tick copy
+  // Search slots: at most `free_slots` seats think at once
+  pthread_mutex_t pool_lock;
+  pthread_cond_t pool_cond;
+  int free_slots;
+  FILE *stats;
+} SeatGroup;
+
+typedef struct {
+  SeatGroup *g;
+  int id;
+  int fd; // pipe to the master
+  CenteEngine *engine;
+} Seat;
+
+static void read_players(const game *gs, cente_snapshot *s) {
+  int P = (int)gs->cantPlayers;
+  if (P > CENTE_MAX_PLAYERS)
+    P = CENTE_MAX_PLAYERS;
+  s->num_players = P;
   for (int i = 0; i < P; i++) {
-    hx[i] = gs->players[i].qx;
-    hy[i] = gs->players[i].qy;
-    blocked[i] = (unsigned char)gs->players[i].blocked;
-    score[i] = gs->players[i].score;
+    s->hx[i] = gs->players[i].qx;
+    s->hy[i] = gs->players[i].qy;
+    s->blocked[i] = (unsigned char)gs->players[i].blocked;
+    s->score[i] = gs->players[i].score;
+    s->valid[i] = gs->players[i].validMove;
+    s->invalid[i] = gs->players[i].invalidMove;
   }
-  Board *b = board_create_from_shared(w, h, P, hx, hy, blocked, score,
-                                      gs->startBoard, player_id);
-  if (!b)
-    return -1;
+}
+
+// The master only writes the state when it applies a move or blocks a player
+static int tick_changed(const game *gs, const cente_snapshot *s) {
+  if ((int)gs->cantPlayers != s->num_players)
+    return 1;
+  for (int i = 0; i < s->num_players; i++)
+    if (gs->players[i].validMove != s->valid[i] ||
+        gs->players[i].invalidMove != s->invalid[i] ||
+        (unsigned char)gs->players[i].blocked != s->blocked[i])
+      return 1;
+  return 0;
+}
 
-  InfluenceMap *inf = influence_create(w, h);
-  if (!inf) {
-    board_destroy(b);
+static int take_snapshot(SeatGroup *g, Seat *seat, cente_snapshot *s) {
+  if (!g->cells) {
+    if (acquire_read_access(g->sem) == -1)
+      return -1;
+    read_players(g->gs, s);
+    engine_sync(seat->engine, s->num_players, s->hx, s->hy, s->blocked,
+                s->score, s->valid, g->gs->startBoard);
+    return release_read_access(g->sem);
+  }
+  pthread_mutex_lock(&g->lock);
+  if (acquire_read_access(g->sem) == -1) {
+    pthread_mutex_unlock(&g->lock);
     return -1;
   }
-
-  cente_size_params base = cente_defaults_for_size(w, h);
-  compute_influence_full(b, player_id, base.sigma, inf);
-  cente_phase ph;
-  cente_weights wts;
-  phase_detect(b, inf, &ph, &wts);
-
-  cente_size_params tuned;
-  float tempo = cente_autotune(b, player_id, inf, ph, &base, &tuned);
-  (void)tempo;
-  if (fabsf(tuned.sigma - base.sigma) > 1e-6f) {
-    // Recompute influence with new sigma
-    compute_influence_full(b, player_id, tuned.sigma, inf);
+  if (!g->have_tick || tick_changed(g->gs, &g->tick)) {
+    read_players(g->gs, &g->tick);
+    memcpy(g->cells, g->gs->startBoard,
+           (size_t)g->gs->width * (size_t)g->gs->height * sizeof(int));
+    g->have_tick = 1;
   }
-  mcts_set_size_params(&tuned);
-  CenteMove mv =
-      mcts_select(b, player_id, inf, &wts, &tuned.mcts, tuned.budget_ms);
+  int rc = release_read_access(g->sem);
+  *s = g->tick;
+  engine_sync(seat->engine, s->num_players, s->hx, s->hy, s->blocked,
+              s->score, s->valid, g->cells);
+  pthread_mutex_unlock(&g->lock);
+  return rc;
+}
+
+static void pool_enter(SeatGroup *g) {
+  pthread_mutex_lock(&g->pool_lock);
+  while (g->free_slots == 0)
+    pthread_cond_wait(&g->pool_cond, &g->pool_lock);
+  g->free_slots--;
+  pthread_mutex_unlock(&g->pool_lock);
+}
+
+static void pool_leave(SeatGroup *g) {
+  pthread_mutex_lock(&g->pool_lock);
+  g->free_slots++;
+  pthread_cond_signal(&g->pool_cond);
+  pthread_mutex_unlock(&g->pool_lock);
+}
 
-  // Map move to direction 0..7
+// Map move to direction 0..7
+static int move_direction(const Board *b, int player_id, CenteMove mv) {
   static const int dx[8] = {0, 1, 1, 1, 0, -1, -1, -1};
   static const int dy[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
-  int sx = gs->players[player_id].qx;
-  int sy = gs->players[player_id].qy;
-  int dir = -1;
+  int sx = b->head_x[player_id];
+  int sy = b->head_y[player_id];
   for (int d = 0; d < 8; d++)
-    if (sx + dx[d] == mv.x && sy + dy[d] == mv.y) {
-      dir = d;
+    if (sx + dx[d] == mv.x && sy + dy[d] == mv.y)
+      return d;
+  return -1;
+}
+
+static int choose_cente_move(CenteEngine *e, int pondered_ms) {
+  cente_size_params base =
+      cente_params_for_size(&e->params, e->width, e->height);
+  // The tier budget only seeds the turn clock, which follows the master
+  CenteBudget budget = turn_clock_budget(&e->clock, base.budget_ms);
+  CenteMove mv = engine_choose(e, budget, pondered_ms);
+  return move_direction(e->board, e->self_id, mv);
+}
+
+static void *seat_main(void *arg) {
+  Seat *seat = (Seat *)arg;
+  SeatGroup *g = seat->g;
+  CenteEngine *engine = seat->engine;
+  cente_snapshot snap;
+  int prev_count = -1;
+  int wrote = 0; // a move is pending since the last turn
+  int turn = 0;
+  while (!g->gs->ended) {
+    if (wait_for_turn(g->sem, seat->id) == -1) {
+      break;
+    }
+    turn_clock_wake(&engine->clock);
+    int pondered_ms = engine->has_ponder ? ponder_stop(&engine->ponder) : 0;
+    unsigned long long t_sync = cente_now_us();
+    if (take_snapshot(g, seat, &snap) == -1) {
+      break;
+    }
+    double sync_ms = (double)(cente_now_us() - t_sync) / 1000.0;
+    int am_blocked = snap.blocked[seat->id];
+    int count = (int)(snap.valid[seat->id] + snap.invalid[seat->id]);
+    int skip_write = count == prev_count;
+    prev_count = count;
+    if (wrote) {
+      // Our move had not been applied yet if the count did not move
+      turn_clock_feedback(&engine->clock, !skip_write);
+      wrote = 0;
+    }
+    if (am_blocked) {
+      close(seat->fd);
+      break;
+    }
+    if (skip_write) {
+      // Not our turn after all: keep pondering; the next stop counts both
+      if (engine->has_ponder)
+        ponder_resume(&engine->ponder);
+      continue;
+    }
+    pool_enter(g);
+    int move_direction = choose_cente_move(engine, pondered_ms);
+    pool_leave(g);
+    if (move_direction == -1) {
+      move_direction = rand() % 8;
+    }
+    unsigned char b = (unsigned char)move_direction;
+    ssize_t bytes_written = write(seat->fd, &b, 1);
+    if (bytes_written != 1) {
+      perror("player_cente write");
       break;
     }
+    wrote = 1;
+    // Logged once the move is out, so the log never delays it
+    if (g->stats) {
+      engine->stats.turn = turn;
+      engine->stats.sync_ms = sync_ms;
+      cente_stats_write(g->stats, &engine->stats);
+    }
+    turn++;
+  }
+  return NULL;
+}
 
-  influence_destroy(inf);
-  board_destroy(b);
-  return dir;
+// Our seats in ascending order: every player whose pid is ours
+static int find_seats(const game *gs, semaphore_struct *sem, int *ids,
+                      int want) {
+  pid_t self = getpid();
+  int found = 0;
+  for (int attempt = 0; attempt < SEAT_LOOKUP_TRIES && found < want;
+       attempt++) {
+    if (attempt > 0) {
+      struct timespec ts = {0, SEAT_LOOKUP_SLEEP_NS};
+      nanosleep(&ts, NULL);
+    }
+    if (acquire_read_access(sem) != 0)
+      continue;
+    found = 0;
+    for (unsigned int i = 0; i < gs->cantPlayers && found < want; i++)
+      if (gs->players[i].pid == self)
+        ids[found++] = (int)i;
+    release_read_access(sem);
+  }
+  return found;
 }
 
 int main(int argc, char *argv[]) {
-  if (argc != 3) {
-    fprintf(stderr, "Usage: %s <width> <height>\n", argv[0]);
+  int seats = argc == 4 ? atoi(argv[3]) : 1;
+  if ((argc != 3 && argc != 4) || seats < 1 || seats > CENTE_MAX_PLAYERS) {
+    fprintf(stderr, "Usage: %s <width> <height> [seats]\n", argv[0]);
     return EXIT_FAILURE;
   }
-  (void)argv;
 
   game *game_state = open_shared_memory();
   semaphore_struct *sem_state = open_semaphore_memory();
@@ -88,66 +249,69 @@ int main(int argc, char *argv[]) {
             "player_cente: Failed to open shared memory or semaphores\n");
     return EXIT_FAILURE;
   }
+  int w = game_state->width, h = game_state->height;
+  size_t game_size = sizeof(game) + (size_t)w * (size_t)h * sizeof(int);
 
   srand((unsigned int)(time(NULL) ^ getpid()));
 
-  int player_id = -1;
-  pid_t self = getpid();
-  for (int attempt = 0; attempt < 200 && player_id < 0; attempt++) {
-    if (acquire_read_access(sem_state) == 0) {
-      for (unsigned int i = 0; i < game_state->cantPlayers; i++) {
-        if (game_state->players[i].pid == self) {
-          player_id = (int)i;
-          break;
-        }
-      }
-      release_read_access(sem_state);
-    }
-  }
-  if (player_id < 0) {
+  int ids[CENTE_MAX_PLAYERS];
+  if (find_seats(game_state, sem_state, ids, seats) < seats) {
     close_semaphore_memory(sem_state);
-    size_t sz =
-        sizeof(game) + (game_state->width * game_state->height * sizeof(int));
-    close_shared_memory(game_state, sz);
+    close_shared_memory(game_state, game_size);
     return EXIT_FAILURE;
   }
 
-  int prev_count = -1;
-  while (!game_state->ended) {
-    if (wait_for_turn(sem_state, player_id) == -1) {
-      break;
-    }
-    if (acquire_read_access(sem_state) == -1) {
-      break;
-    }
-    int am_blocked = game_state->players[player_id].blocked;
-    int move_direction = choose_cente_move(game_state, sem_state, player_id);
-    int count = game_state->players[player_id].validMove +
-                game_state->players[player_id].invalidMove;
-    int skip_write = count == prev_count;
-    prev_count = count;
-    if (release_read_access(sem_state) == -1) {
-      break;
-    }
-    if (am_blocked) {
-      close(STDOUT_FILENO);
-      break;
-    }
-    if (move_direction == -1) {
-      move_direction = rand() % 8;
+  // Shared tables are built once here; seats only read them
+  int P = (int)game_state->cantPlayers;
+  zobrist_init(w, h, P);
+  kernels_init(w, h);
+  eval_init(w, h);
+  rollout_init(w, h);
+
+  int threads =
+      CENTE_SEAT_THREADS > 0 ? CENTE_SEAT_THREADS : cente_usable_cpus();
+  SeatGroup g = {game_state, sem_state, NULL, {0}, 0,
+                 PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+                 PTHREAD_COND_INITIALIZER, threads < 1 ? 1 : threads, NULL};
+  Seat seat[CENTE_MAX_PLAYERS];
+  int ok = 1;
+  if (seats > 1) {
+    g.cells = (int *)malloc((size_t)w * (size_t)h * sizeof(int));
+    ok = g.cells != NULL;
+  }
+  for (int k = 0; k < seats; k++) {
+    seat[k].g = &g;
+    seat[k].id = ids[k];
+    seat[k].fd = k == 0 ? STDOUT_FILENO : PLAYER_SEAT_FD(k);
+    seat[k].engine = ok ? engine_create(w, h, P, ids[k]) : NULL;
+    ok = ok && seat[k].engine;
+    // Our own seats would ponder against each other's searches
+    if (ok && seats > 1 && seat[k].engine->has_ponder) {
+      ponder_destroy(&seat[k].engine->ponder);
+      seat[k].engine->has_ponder = 0;
     }
-    if (!skip_write) {
-      unsigned char b = (unsigned char)move_direction;
-      ssize_t bytes_written = write(STDOUT_FILENO, &b, 1);
-      if (bytes_written != 1) {
-        perror("player_cente write");
+  }
+
+  if (ok) {
+    g.stats = cente_stats_open();
+    pthread_t tid[CENTE_MAX_PLAYERS];
+    int started = 1;
+    for (; started < seats; started++)
+      if (pthread_create(&tid[started], NULL, seat_main, &seat[started]) != 0)
         break;
-      }
-    }
+    // Seats without a thread close their pipe so the master blocks them
+    for (int k = started; k < seats; k++)
+      close(seat[k].fd);
+    seat_main(&seat[0]);
+    for (int k = 1; k < started; k++)
+      pthread_join(tid[k], NULL);
+    cente_stats_close(g.stats);
   }
 
+  for (int k = 0; k < seats; k++)
+    engine_destroy(seat[k].engine);
+  free(g.cells);
   close_semaphore_memory(sem_state);
-  size_t game_size = sizeof(game) + (game_state->width * game_state->height * sizeof(int));
   close_shared_memory(game_state, game_size);
-  return EXIT_SUCCESS;
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
 }